@@ -0,0 +1,48 @@
+#ifndef BINARYSPILL_H
+#define BINARYSPILL_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "DataSink.h"
+#include "DataSource.h"
+#include "XMLEntity.h"
+
+// Binary format for handing entities and rows between pipeline stages
+// without escaping and reparsing text. A stream starts with the magic "SPL1"
+// and a flags byte, then holds records of a type byte followed by varint
+// lengths and raw bytes. With the name dictionary on, an element or
+// attribute name is written out once and referred to by index afterwards.
+// Entity and row records can be mixed in one stream.
+enum class ESpillRecord{End, Entity, Row, Error};
+
+class CBinarySpillWriter{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        CBinarySpillWriter(std::shared_ptr< CDataSink > sink, bool dictionary = true);
+        ~CBinarySpillWriter();
+
+        bool WriteEntity(const SXMLEntity &entity);
+        bool WriteRow(const std::vector< std::string > &row);
+        bool Flush();
+};
+
+class CBinarySpillReader{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        CBinarySpillReader(std::shared_ptr< CDataSource > src);
+        ~CBinarySpillReader();
+
+        bool End();
+        ESpillRecord Next();
+        bool ReadEntity(SXMLEntity &entity);
+        bool ReadRow(std::vector< std::string > &row);
+};
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef COMPRESSEDDATASINK_H
+#define COMPRESSEDDATASINK_H
+
+#include <memory>
+#include "DataSink.h"
+#include "Compression.h"
+
+// Compresses everything written before passing it to the wrapped sink. Flush
+// completes the compressed stream, writing after a Flush starts a new member
+// (gzip) or stream (zlib) which CCompressedDataSource reads as a continuation. When background is set the
+// compression runs on a worker thread.
+class CCompressedDataSink : public CDataSink{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+        
+    public:
+        CCompressedDataSink(std::shared_ptr< CDataSink > sink, ECompressionFormat format = ECompressionFormat::Gzip, int level = 6, bool background = false);
+        ~CCompressedDataSink();
+        
+        bool Put(const char &ch) noexcept override;
+        bool Write(const std::vector<char> &buf) noexcept override;
+        bool Flush() noexcept override;
+};
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef COMPRESSEDDATASOURCE_H
+#define COMPRESSEDDATASOURCE_H
+
+#include <memory>
+#include "DataSource.h"
+#include "Compression.h"
+
+// Decompresses the wrapped source on the fly. The format is detected from the
+// first bytes of the stream, data that is not compressed passes through.
+class CCompressedDataSource : public CDataSource{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+        
+    public:
+        CCompressedDataSource(std::shared_ptr< CDataSource > src);
+        ~CCompressedDataSource();
+        
+        ECompressionFormat Format() const noexcept;
+        bool Error() const noexcept;
+        
+        bool End() const noexcept override;
+        bool Get(char &ch) noexcept override;
+        bool Peek(char &ch) noexcept override;
+        bool Read(std::vector<char> &buf, std::size_t count) noexcept override;
+};
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef COMPRESSION_H
+#define COMPRESSION_H
+
+// Stream formats understood by the compressing sink and decompressing source.
+// None passes data through untouched.
+enum class ECompressionFormat{None, Gzip, Zlib, Zstd};
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef DSVAGGREGATOR_H
+#define DSVAGGREGATOR_H
+
+#include <memory>
+#include <vector>
+#include "DataSource.h"
+#include "DSVWriter.h"
+
+enum class EDSVAggregateFunction{Count, Sum, Min, Max, Mean};
+enum class EDSVAggregateType{Integer, Double};
+
+// One output column of an aggregation. Count counts rows and ignores the
+// column; the others use the values of DColumn that parse as DType, other
+// values are skipped.
+struct SDSVAggregate{
+    EDSVAggregateFunction DFunction = EDSVAggregateFunction::Count;
+    std::size_t DColumn = 0;
+    EDSVAggregateType DType = EDSVAggregateType::Double;
+};
+
+// Group by of DSV rows on key columns. Rows are scanned without building a
+// row vector, only the key and aggregated columns are extracted, and groups
+// are kept in an open addressing hash table keyed on the raw bytes of the key
+// fields. With more than one thread the groups are partitioned by hash and
+// each partition is updated by its own worker while the caller scans.
+// Write outputs one row per group, the key fields followed by the aggregates,
+// in the order the groups were first seen. Sum of no values is 0, Min, Max
+// and Mean of no values are empty. An integer Sum or Mean whose total leaves
+// the range of int64 is written empty and makes Consume return false.
+class CDSVAggregator{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        CDSVAggregator(std::vector< std::size_t > keycolumns, std::vector< SDSVAggregate > aggregates, std::size_t threads = 1);
+        ~CDSVAggregator();
+
+        bool Consume(std::shared_ptr< CDataSource > src, char delimiter, bool header = false);
+        std::size_t GroupCount() const;
+        bool Write(CDSVWriter &writer) const;
+};
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef DSVDIALECT_H
+#define DSVDIALECT_H
+
+// Describes the characters a DSV reader or writer treats specially. Readers
+// and writers are templated on the dialect type so a dialect fixed at compile
+// time folds its comparisons into the scan loop, while SDSVRuntimeDialect
+// keeps the existing runtime configuration. A quote of '\0' disables quoting.
+
+template <char Delimiter, char Quote = '"', bool QuoteAll = false>
+struct SDSVStaticDialect{
+    constexpr char DelimiterChar() const noexcept{
+        return Delimiter;
+    };
+    
+    constexpr char QuoteChar() const noexcept{
+        return Quote;
+    };
+    
+    constexpr bool Quoting() const noexcept{
+        return Quote != '\0';
+    };
+    
+    constexpr bool QuoteAllFields() const noexcept{
+        return QuoteAll && Quote != '\0';
+    };
+};
+
+struct SDSVRuntimeDialect{
+    char DDelimiter;
+    char DQuote;
+    bool DQuoteAll;
+    
+    SDSVRuntimeDialect(char delimiter, char quote = '"', bool quoteall = false) 
+        : DDelimiter(delimiter), DQuote(quote), DQuoteAll(quoteall){
+    
+    };
+    
+    char DelimiterChar() const noexcept{
+        return DDelimiter;
+    };
+    
+    char QuoteChar() const noexcept{
+        return DQuote;
+    };
+    
+    bool Quoting() const noexcept{
+        return DQuote != '\0';
+    };
+    
+    bool QuoteAllFields() const noexcept{
+        return DQuoteAll && DQuote != '\0';
+    };
+};
+
+using SCSVDialect = SDSVStaticDialect<','>;
+using STSVDialect = SDSVStaticDialect<'\t', '\0'>;
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef DSVINDEX_H
+#define DSVINDEX_H
+
+#include <memory>
+#include <vector>
+#include "DataSource.h"
+#include "DataSink.h"
+#include "DSVReader.h"
+#include "DSVReadOptions.h"
+
+// Byte offsets of every stride-th row of a DSV stream, found with the same
+// scanner and read options as CDSVReader so rows match the reader's: newlines
+// inside quoted values do not start rows and rows dropped under the SkipRow or
+// Fail policy are not counted. Offsets count from the first byte Build reads.
+// The index can be saved to and loaded from a sidecar sink/source, and used to
+// open a reader at any row of a source that supports Seek.
+class CDSVIndex{
+    private:
+        std::size_t DStride;
+        std::size_t DRowCount;
+        std::vector< std::size_t > DOffsets;
+        
+    public:
+        CDSVIndex(std::size_t stride = 1024);
+        
+        std::size_t Stride() const noexcept;
+        std::size_t RowCount() const noexcept;
+        std::size_t Offset(std::size_t row) const noexcept;
+        
+        bool Build(CDataSource &src, char delimiter = ',', const SDSVReadOptions &options = SDSVReadOptions());
+        bool Save(CDataSink &sink) const;
+        bool Load(CDataSource &src);
+        
+        std::unique_ptr< CDSVReader > OpenAt(std::shared_ptr< CDataSource > src, char delimiter, std::size_t row, const SDSVReadOptions &options = SDSVReadOptions()) const;
+};
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef DSVPROJECTIONREADER_H
+#define DSVPROJECTIONREADER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "DataSource.h"
+
+enum class EDSVColumnType{Infer, String, Integer, Double};
+
+// Column to project, by position or by header name
+struct SDSVColumn{
+    std::size_t DIndex = 0;
+    std::string DName;
+    EDSVColumnType DType = EDSVColumnType::Infer;
+};
+
+// Value of one projected column, DValid is false when the field was missing,
+// empty or did not parse as the column type
+struct SDSVValue{
+    EDSVColumnType DType = EDSVColumnType::String;
+    bool DValid = false;
+    std::int64_t DInteger = 0;
+    double DDouble = 0.0;
+    std::string DString;
+};
+
+// Reads only the selected columns of a DSV stream. Unselected values are
+// scanned over without being built and numeric columns are converted with
+// std::from_chars. When header is set the first row names the columns;
+// columns given by DName are resolved against it. Columns left as Infer are
+// typed from the first samplerows rows, which are still returned.
+class CDSVProjectionReader{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+        
+    public:
+        CDSVProjectionReader(std::shared_ptr< CDataSource > src, char delimiter, std::vector< SDSVColumn > columns, bool header = false, std::size_t samplerows = 100);
+        ~CDSVProjectionReader();
+        
+        bool Valid() const;
+        const std::vector< SDSVColumn > &Columns() const;
+        
+        bool End() const;
+        bool ReadRow(std::vector< SDSVValue > &values);
+};
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef DSVPUSHPARSER_H
+#define DSVPUSHPARSER_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "DSVReadOptions.h"
+
+// DSV parser the caller pushes bytes into, for input that arrives in pieces
+// such as a non-blocking socket. Feed takes chunks split anywhere, even inside
+// a quoted value or between the two quotes of an escape, and every row it
+// completes can be taken with ReadRow. The scan state is kept between calls so
+// no byte is looked at twice. Finish ends the input and completes the last
+// row. Rows match those of CDSVReader for the same bytes and options; under
+// the Fail policy a malformed row is dropped and Feed or Finish returns false.
+// A consumer waiting for rows registers with OnReady and is called back from
+// the Feed or Finish that makes them available.
+class CDSVPushParser{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        CDSVPushParser(char delimiter, const SDSVReadOptions &options = SDSVReadOptions());
+        ~CDSVPushParser();
+
+        bool Feed(const char *data, std::size_t size);
+        bool Feed(std::string_view data);
+        bool Finish();
+
+        void OnReady(std::function<void()> callback);
+        std::size_t RowsReady() const;
+        bool ReadRow(std::vector<std::string> &row);
+        bool End() const;
+
+        const std::vector<SDSVError> &Errors() const;
+        void ClearErrors();
+};
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef DSVREADOPTIONS_H
+#define DSVREADOPTIONS_H
+
+#include <cstddef>
+
+// How a reader reacts to a malformed row. Lenient keeps the historical
+// behavior and records nothing, Report records the error and returns the row
+// as parsed, SkipRow records it and moves on to the next row, and Fail
+// records it and makes ReadRow return false (the next call continues with the
+// following row).
+enum class EDSVErrorPolicy{Lenient, Report, SkipRow, Fail};
+
+struct SDSVReadOptions{
+    bool DStripCR = false;      // treat "\r\n" outside quotes as a row end
+    bool DSkipBOM = false;      // drop a UTF-8 byte order mark at the start
+    EDSVErrorPolicy DErrorPolicy = EDSVErrorPolicy::Lenient;
+};
+
+struct SDSVError{
+    enum class EType{QuoteInValue, DataAfterQuote, UnterminatedQuote};
+    EType DType;
+    std::size_t DOffset;    // byte offset of the offending character
+    std::size_t DRow;       // zero based, counting skipped rows
+    std::size_t DColumn;    // zero based value index within the row
+};
+
+#endif
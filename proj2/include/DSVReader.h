@@ -2,8 +2,11 @@
 #define DSVREADER_H
 
 #include <memory>
+#include <memory_resource>
 #include <string>
+#include <vector>
 #include "DataSource.h"
+#include "DSVReadOptions.h"
 
 class CDSVReader{
     private:
@@ -12,10 +15,15 @@ class CDSVReader{
 
     public:
         CDSVReader(std::shared_ptr< CDataSource > src, char delimiter);
+        CDSVReader(std::shared_ptr< CDataSource > src, char delimiter, const SDSVReadOptions &options);
         ~CDSVReader();
 
         bool End() const;
         bool ReadRow(std::vector<std::string> &row);
+        bool ReadRow(std::pmr::vector<std::pmr::string> &row);
+        
+        const std::vector<SDSVError> &Errors() const;
+        void ClearErrors();
 };
 
 #endif
@@ -0,0 +1,171 @@
+#ifndef DSVREADERT_H
+#define DSVREADERT_H
+
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "DataSource.h"
+#include "DSVDialect.h"
+#include "DSVReadOptions.h"
+#include "DSVScanner.h"
+
+// DSV reader specialized on a dialect type, see DSVDialect.h. Input is pulled
+// from the source a block at a time and handed to a CDSVBasicScanner, which
+// appends runs of ordinary characters to the current value in one step. CRLF,
+// BOM and malformed quote handling from SDSVReadOptions happen in the same
+// pass.
+template <typename TDialect>
+class CDSVBasicReader{
+    private:
+        static constexpr std::size_t DBlockSize = 4096;
+        
+        std::shared_ptr< CDataSource > DSource;
+        SDSVReadOptions DOptions;
+        CDSVBasicScanner< TDialect > DScanner;
+        std::vector< char > DBuffer;
+        std::size_t DIndex;
+        std::size_t DBase;      // stream offset of DBuffer[0]
+        bool DStarted;
+        std::vector< std::string > DSpare;  // buffers of values dropped by narrow rows
+        
+        // Makes sure unread input is buffered, false once the source is drained
+        bool Fill(){
+            if(DIndex < DBuffer.size()){
+                return true;
+            }
+            DBase += DBuffer.size();
+            DIndex = 0;
+            if(!DSource->Read(DBuffer, DBlockSize)){
+                DBuffer.clear();
+                return false;
+            }
+            return true;
+        };
+        
+        void SkipBOM(){
+            DStarted = true;
+            if(!DOptions.DSkipBOM || !Fill()){
+                return;
+            }
+            // a source giving short reads may split the mark across blocks
+            std::vector< char > More;
+            while(DBuffer.size() < 3 && DSource->Read(More, DBlockSize)){
+                DBuffer.insert(DBuffer.end(), More.begin(), More.end());
+            }
+            if(DBuffer.size() >= 3 && DBuffer[0] == '\xEF' && DBuffer[1] == '\xBB' && DBuffer[2] == '\xBF'){
+                DIndex += 3;
+            }
+        };
+        
+        // Returns the slot for value index of row cleared for reuse, appending
+        // a spare string or a new one when the row is not yet that wide
+        template <typename TRow>
+        typename TRow::value_type &Field(TRow &row, std::size_t index){
+            if(index < row.size()){
+                row[index].clear();
+                return row[index];
+            }
+            if constexpr(std::is_same< TRow, std::vector< std::string > >::value){
+                if(!DSpare.empty()){
+                    row.emplace_back(std::move(DSpare.back()));
+                    DSpare.pop_back();
+                    row[index].clear();
+                    return row[index];
+                }
+            }
+            row.emplace_back();
+            return row[index];
+        };
+
+        // Moves the strings past fieldcount to the spares, last first so
+        // they come back in the same order, so a narrow row does not free
+        // the buffers a wider one will need again. Rows of other string
+        // types, such as std::pmr, are simply shrunk.
+        template <typename TRow>
+        void Trim(TRow &row, std::size_t fieldcount){
+            if constexpr(std::is_same< TRow, std::vector< std::string > >::value){
+                while(row.size() > fieldcount){
+                    DSpare.push_back(std::move(row.back()));
+                    row.pop_back();
+                }
+            }
+            else{
+                row.resize(fieldcount);
+            }
+        };
+        
+    public:
+        CDSVBasicReader(std::shared_ptr< CDataSource > src, TDialect dialect = TDialect(), SDSVReadOptions options = SDSVReadOptions()) 
+            : DSource(std::move(src)), DOptions(options), DScanner(dialect, options), DIndex(0), DBase(0), DStarted(false){
+            
+        };
+        
+        bool End() const{
+            return DIndex >= DBuffer.size() && DSource->End();
+        };
+        
+        // Offset in the source of the next byte to be scanned
+        std::size_t Offset() const noexcept{
+            return DBase + DIndex;
+        };
+        
+        // Errors recorded so far, empty under the lenient policy
+        const std::vector< SDSVError > &Errors() const noexcept{
+            return DScanner.Errors();
+        };
+        
+        void ClearErrors() noexcept{
+            DScanner.ClearErrors();
+        };
+        
+        // Scans the next row calling target(index) at the start of every
+        // value, target returns the string the value is appended to (a
+        // std::string or std::pmr::string) or nullptr to skip over the value
+        // without building it. fieldcount is set to the number of values, a
+        // trailing empty value is not counted.
+        template <typename TFieldTarget>
+        bool ScanRow(TFieldTarget &&target, std::size_t &fieldcount){
+            if(!DStarted){
+                SkipBOM();
+            }
+            decltype(target(std::size_t())) Value = nullptr;
+            while(true){
+                bool RowEnd = true;
+                if(Fill()){
+                    DIndex += DScanner.Scan(DBuffer.data() + DIndex, DBuffer.size() - DIndex, DBase + DIndex, target, Value, RowEnd);
+                    if(!RowEnd){
+                        continue;
+                    }
+                }
+                else if(!DScanner.Finish(Value, DBase + DIndex)){
+                    return false;
+                }
+                if(!DScanner.SkipRow()){
+                    fieldcount = DScanner.FieldCount();
+                    return !DScanner.FailRow();
+                }
+            }
+        };
+        
+        // Reads the next row into row, the strings already held by row are
+        // reused so their capacity carries over from one call to the next.
+        // TRow is any vector of strings, for instance one using std::pmr.
+        template <typename TRow>
+        bool ReadRow(TRow &row){
+            std::size_t FieldCount;
+            if(!ScanRow([this, &row](std::size_t index){ return &Field(row, index); }, FieldCount)){
+                return false;
+            }
+            Trim(row, FieldCount);
+            return true;
+        };
+};
+
+template <char Delimiter, char Quote = '"'>
+using CDSVReaderT = CDSVBasicReader< SDSVStaticDialect<Delimiter, Quote> >;
+
+using CCSVReader = CDSVBasicReader< SCSVDialect >;
+using CTSVReader = CDSVBasicReader< STSVDialect >;
+
+#endif
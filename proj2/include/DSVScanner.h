@@ -0,0 +1,239 @@
+#ifndef DSVSCANNER_H
+#define DSVSCANNER_H
+
+#include <cstddef>
+#include <vector>
+#include "DSVDialect.h"
+#include "DSVReadOptions.h"
+
+// Resumable DSV row scanner shared by the pull reader and the push parser.
+// Bytes are handed over in blocks split anywhere, even inside a quoted value
+// or between the two quotes of an escape; the state of the row in progress is
+// kept between calls so no byte is looked at twice. The only lookahead, the
+// character after a quote inside quotes and after a CR, is remembered as a
+// pending flag until the next block or Finish. Runs of ordinary characters
+// are appended to the current value in one step.
+template <typename TDialect>
+class CDSVBasicScanner{
+    private:
+        TDialect DDialect;
+        SDSVReadOptions DOptions;
+        std::vector< SDSVError > DErrors;
+        std::size_t DRow;       // rows scanned so far
+        std::size_t DFieldCount;
+        bool DInRow;            // bytes of the current row have been seen
+        bool DHasData;
+        bool DInQuotes;
+        bool DClosed;           // value had a closing quote
+        bool DMalformed;
+        bool DPendingQuote;     // quote seen inside quotes at the end of a block
+        bool DPendingCR;        // CR seen outside quotes at the end of a block
+
+        bool IsSpecial(char ch) const noexcept{
+            return ch == '\n' || ch == DDialect.DelimiterChar() || (DDialect.Quoting() && ch == DDialect.QuoteChar()) || (ch == '\r' && DOptions.DStripCR);
+        };
+
+        // Records the first error of a row unless lenient
+        void Error(SDSVError::EType type, std::size_t offset){
+            if(DOptions.DErrorPolicy != EDSVErrorPolicy::Lenient && !DMalformed){
+                DErrors.push_back(SDSVError{type, offset, DRow, DFieldCount});
+                DMalformed = true;
+            }
+        };
+
+        template <typename TValue>
+        void Append(TValue *value, char ch){
+            if(value){
+                value->push_back(ch);
+            }
+            DHasData = true;
+        };
+
+        void EndRow(){
+            DInRow = false;
+            DRow++;
+            if(DHasData){
+                DFieldCount++;
+            }
+        };
+
+    public:
+        CDSVBasicScanner(TDialect dialect = TDialect(), SDSVReadOptions options = SDSVReadOptions())
+            : DDialect(dialect), DOptions(options), DRow(0), DFieldCount(0), DInRow(false), DHasData(false), DInQuotes(false),
+              DClosed(false), DMalformed(false), DPendingQuote(false), DPendingCR(false){
+
+        };
+
+        // Scans data until a row ends or the block is used up and returns the
+        // bytes consumed, rowend tells which. target(index) is called at the
+        // start of every value and returns the string the value is appended
+        // to (a std::string or std::pmr::string) or nullptr to skip over it.
+        // value holds that string while the row is in progress, the caller
+        // keeps it between calls. offset is the stream offset of data[0].
+        template <typename TFieldTarget, typename TValue>
+        std::size_t Scan(const char *data, std::size_t size, std::size_t offset, TFieldTarget &&target, TValue *&value, bool &rowend){
+            const char *Cursor = data;
+            const char *Last = data + size;
+            rowend = false;
+            while(Cursor < Last && !rowend){
+                if(!DInRow){
+                    DInRow = true;
+                    DFieldCount = 0;
+                    DHasData = false;
+                    DInQuotes = false;
+                    DClosed = false;
+                    DMalformed = false;
+                    value = target(DFieldCount);
+                }
+                if(DPendingQuote){
+                    DPendingQuote = false;
+                    if(*Cursor == DDialect.QuoteChar()){
+                        Append(value, *Cursor++);
+                        continue;
+                    }
+                    DInQuotes = false;
+                    DClosed = true;
+                }
+                else if(DPendingCR){
+                    DPendingCR = false;
+                    if(*Cursor == '\n'){
+                        Cursor++;
+                        EndRow();
+                        rowend = true;
+                        continue;
+                    }
+                    Append(value, '\r');
+                }
+                if(!DInQuotes){
+                    const char *Stop = Cursor;
+                    while(Stop < Last && !IsSpecial(*Stop)){
+                        Stop++;
+                    }
+                    if(Stop != Cursor){
+                        if(DClosed){
+                            Error(SDSVError::EType::DataAfterQuote, offset + (Cursor - data));
+                        }
+                        if(value){
+                            value->append(Cursor, Stop);
+                        }
+                        DHasData = true;
+                    }
+                    Cursor = Stop;
+                    if(Stop == Last){
+                        break;
+                    }
+                    Cursor++;
+                    if(*Stop == '\n'){
+                        EndRow();
+                        rowend = true;
+                    }
+                    else if(*Stop == DDialect.DelimiterChar()){
+                        DFieldCount++;
+                        value = target(DFieldCount);
+                        DHasData = false;
+                        DClosed = false;
+                    }
+                    else if(*Stop == '\r'){
+                        // only a CR directly followed by LF ends the row
+                        if(Cursor == Last){
+                            DPendingCR = true;
+                        }
+                        else if(*Cursor == '\n'){
+                            Cursor++;
+                            EndRow();
+                            rowend = true;
+                        }
+                        else{
+                            Append(value, '\r');
+                        }
+                    }
+                    else{
+                        if(DHasData){
+                            Error(SDSVError::EType::QuoteInValue, offset + (Stop - data));
+                        }
+                        DInQuotes = true;
+                    }
+                }
+                else{
+                    const char *Stop = Cursor;
+                    while(Stop < Last && *Stop != DDialect.QuoteChar()){
+                        Stop++;
+                    }
+                    if(Stop != Cursor){
+                        if(value){
+                            value->append(Cursor, Stop);
+                        }
+                        DHasData = true;
+                    }
+                    Cursor = Stop;
+                    if(Stop == Last){
+                        break;
+                    }
+                    Cursor++;
+                    // a doubled quote is a literal quote, a single one closes
+                    if(Cursor == Last){
+                        DPendingQuote = true;
+                    }
+                    else if(*Cursor == DDialect.QuoteChar()){
+                        Append(value, *Cursor++);
+                    }
+                    else{
+                        DInQuotes = false;
+                        DClosed = true;
+                    }
+                }
+            }
+            return Cursor - data;
+        };
+
+        // Ends the input, completing a row left without a trailing newline.
+        // False if no row was in progress.
+        template <typename TValue>
+        bool Finish(TValue *&value, std::size_t offset){
+            if(DPendingQuote){
+                DPendingQuote = false;
+                DInQuotes = false;
+                DClosed = true;
+            }
+            if(DPendingCR){
+                DPendingCR = false;
+                Append(value, '\r');
+            }
+            if(!DInRow){
+                return false;
+            }
+            if(DInQuotes){
+                Error(SDSVError::EType::UnterminatedQuote, offset);
+                DInQuotes = false;
+            }
+            EndRow();
+            return true;
+        };
+
+        // Values in the row that just ended, a trailing empty value is not
+        // counted
+        std::size_t FieldCount() const noexcept{
+            return DFieldCount;
+        };
+
+        // The row that just ended is to be dropped under the SkipRow policy
+        bool SkipRow() const noexcept{
+            return DMalformed && DOptions.DErrorPolicy == EDSVErrorPolicy::SkipRow;
+        };
+
+        // The row that just ended is to be reported as a failure
+        bool FailRow() const noexcept{
+            return DMalformed && DOptions.DErrorPolicy == EDSVErrorPolicy::Fail;
+        };
+
+        // Errors recorded so far, empty under the lenient policy
+        const std::vector< SDSVError > &Errors() const noexcept{
+            return DErrors;
+        };
+
+        void ClearErrors() noexcept{
+            DErrors.clear();
+        };
+};
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef DSVSORTER_H
+#define DSVSORTER_H
+
+#include <memory>
+#include <vector>
+#include "DataSink.h"
+#include "DataSource.h"
+
+enum class EDSVSortType{String, Integer, Double};
+
+// Key column of a sort. Integer and Double keys compare numerically; values
+// that do not parse as the type, and NaN, sort before those that do, in
+// string order.
+struct SDSVSortKey{
+    std::size_t DColumn = 0;
+    EDSVSortType DType = EDSVSortType::String;
+    bool DDescending = false;
+};
+
+// Sorts DSV input that may not fit in memory. Rows are read with CDSVReader
+// into runs of at most a share of the memory budget; each run is sorted on a
+// worker thread and spilled to a temporary file in the binary spill format,
+// then the runs are merged through a heap and written with CDSVWriter, which
+// quotes values again as needed. Half the budget is kept for the merge, whose
+// readers bound how many runs are merged at once; as runs pile up they are
+// merged into longer ones, so memory and open files stay bounded however
+// large the input. Input that fits in one run is sorted in memory without
+// temporary files. The sort is stable, so rows with equal keys keep their
+// input order. A header row is copied through first.
+class CDSVSorter{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        CDSVSorter(std::vector< SDSVSortKey > keys, std::size_t memorybudget = 64 * 1024 * 1024, std::size_t threads = 0);
+        ~CDSVSorter();
+
+        bool Sort(std::shared_ptr< CDataSource > src, std::shared_ptr< CDataSink > sink, char delimiter, bool header = false);
+        std::size_t RunCount() const;
+};
+
+#endif
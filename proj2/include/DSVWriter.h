@@ -3,6 +3,8 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 #include "DataSink.h"
 
 class CDSVWriter{
@@ -15,6 +17,7 @@ class CDSVWriter{
         ~CDSVWriter();
 
         bool WriteRow(const std::vector<std::string> &row);
+        bool WriteRow(const std::string_view *fields, std::size_t count);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,94 @@
+#ifndef DSVWRITERT_H
+#define DSVWRITERT_H
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "DataSink.h"
+#include "DSVDialect.h"
+
+// DSV writer specialized on a dialect type, see DSVDialect.h. Each line is
+// built in a buffer that is reused between rows. When the dialect has no
+// quote character values are written verbatim, and a row with a value holding
+// the delimiter or a newline is rejected since it could not be read back.
+template <typename TDialect>
+class CDSVBasicWriter{
+    private:
+        std::shared_ptr< CDataSink > DDataSink;
+        TDialect DDialect;
+        std::vector< char > DBuffer;
+        
+        bool NeedsQuotes(std::string_view field) const noexcept{
+            if(DDialect.QuoteAllFields()){
+                return true;
+            }
+            for(char Ch : field){
+                if(Ch == '\n' || Ch == DDialect.DelimiterChar() || Ch == DDialect.QuoteChar()){
+                    return true;
+                }
+            }
+            return false;
+        };
+        
+        // Appends field, false if it cannot be written unquoted
+        bool AppendField(std::string_view field){
+            if(!DDialect.Quoting()){
+                if(field.find(DDialect.DelimiterChar()) != std::string_view::npos || field.find('\n') != std::string_view::npos){
+                    return false;
+                }
+                DBuffer.insert(DBuffer.end(), field.begin(), field.end());
+                return true;
+            }
+            if(!NeedsQuotes(field)){
+                DBuffer.insert(DBuffer.end(), field.begin(), field.end());
+                return true;
+            }
+            DBuffer.push_back(DDialect.QuoteChar());
+            for(char Ch : field){
+                if(Ch == DDialect.QuoteChar()){
+                    DBuffer.push_back(Ch);
+                }
+                DBuffer.push_back(Ch);
+            }
+            DBuffer.push_back(DDialect.QuoteChar());
+            return true;
+        };
+        
+        template <typename TIterator>
+        bool WriteFields(TIterator first, TIterator last){
+            DBuffer.clear();
+            for(TIterator Field = first; Field != last; ++Field){
+                if(Field != first){
+                    DBuffer.push_back(DDialect.DelimiterChar());
+                }
+                if(!AppendField(*Field)){
+                    return false;
+                }
+            }
+            DBuffer.push_back('\n');
+            return DDataSink->Write(DBuffer);
+        };
+        
+    public:
+        CDSVBasicWriter(std::shared_ptr< CDataSink > sink, TDialect dialect = TDialect()) 
+            : DDataSink(std::move(sink)), DDialect(dialect){
+            
+        };
+        
+        bool WriteRow(const std::vector< std::string > &row){
+            return WriteFields(row.begin(), row.end());
+        };
+        
+        bool WriteRow(const std::string_view *fields, std::size_t count){
+            return WriteFields(fields, fields + count);
+        };
+};
+
+template <char Delimiter, char Quote = '"', bool QuoteAll = false>
+using CDSVWriterT = CDSVBasicWriter< SDSVStaticDialect<Delimiter, Quote, QuoteAll> >;
+
+using CCSVWriter = CDSVBasicWriter< SCSVDialect >;
+using CTSVWriter = CDSVBasicWriter< STSVDialect >;
+
+#endif
@@ -8,6 +8,7 @@ class CDataSink{
         virtual ~CDataSink(){};
         virtual bool Put(const char &ch) noexcept = 0;
         virtual bool Write(const std::vector<char> &buf) noexcept = 0;
+        virtual bool Flush() noexcept{ return true; };
 };
 
 #endif
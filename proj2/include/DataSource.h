@@ -10,6 +10,7 @@ class CDataSource{
         virtual bool Get(char &ch) noexcept = 0;
         virtual bool Peek(char &ch) noexcept = 0;
         virtual bool Read(std::vector<char> &buf, std::size_t count) noexcept = 0;
+        virtual bool Seek(std::size_t offset) noexcept{ (void)offset; return false; };
 };
 
 #endif
@@ -0,0 +1,37 @@
+#ifndef EDITDISTANCEINDEX_H
+#define EDITDISTANCEINDEX_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+struct SEditDistanceMatch{
+    std::size_t DIndex;     // position of the entry in the order it was added
+    int DDistance;
+};
+
+// BK-tree over a dictionary of strings that finds every entry within a given
+// StringUtils::EditDistance of a query, with the same ignorecase handling.
+// Since edit distance obeys the triangle inequality, a lookup only visits
+// the subtrees whose distance to a node is within maxdistance of the query's,
+// instead of comparing the query against every entry. Find may be called
+// from several threads at once; FindAll spreads a batch of queries over a
+// pool of threads. Adding entries must not overlap with lookups.
+class CEditDistanceIndex{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        CEditDistanceIndex(bool ignorecase = false);
+        ~CEditDistanceIndex();
+
+        std::size_t Add(const std::string &entry);
+        std::size_t Size() const;
+        const std::string &Entry(std::size_t index) const;
+
+        std::vector< SEditDistanceMatch > Find(const std::string &query, int maxdistance) const;
+        std::vector< std::vector< SEditDistanceMatch > > FindAll(const std::vector< std::string > &queries, int maxdistance, std::size_t threads = 0) const;
+};
+
+#endif
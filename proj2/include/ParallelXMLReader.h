@@ -0,0 +1,28 @@
+#ifndef PARALLELXMLREADER_H
+#define PARALLELXMLREADER_H
+
+#include <memory>
+#include "XMLEntity.h"
+#include "DataSource.h"
+
+// Reads documents whose root holds a long list of independent records. A
+// pre-scanner cuts the input at the boundaries of the root's child elements
+// and batches of records are parsed by separate expat instances on a pool of
+// threads. Entities come back in document order: the root start element, the
+// entities of each record, then the root end element. Text directly inside
+// the root is dropped, and records cannot rely on namespace prefixes or
+// entities declared outside them.
+class CParallelXMLReader{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+        
+    public:
+        CParallelXMLReader(std::shared_ptr< CDataSource > src, std::size_t threads = 0);
+        ~CParallelXMLReader();
+        
+        bool End() const;
+        bool ReadEntity(SXMLEntity &entity, bool skipcdata = false);
+};
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef READAHEADDATASOURCE_H
+#define READAHEADDATASOURCE_H
+
+#include <memory>
+#include "DataSource.h"
+
+// Reads the wrapped source ahead on a background thread into a ring of
+// buffers so the consumer parses one buffer while the next ones are filled.
+// The wrapped source must not be used by anyone else once wrapped.
+class CReadAheadDataSource : public CDataSource{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+        
+    public:
+        CReadAheadDataSource(std::shared_ptr< CDataSource > src, std::size_t buffersize = 65536, std::size_t buffercount = 4);
+        ~CReadAheadDataSource();
+        
+        bool End() const noexcept override;
+        bool Get(char &ch) noexcept override;
+        bool Peek(char &ch) noexcept override;
+        bool Read(std::vector<char> &buf, std::size_t count) noexcept override;
+};
+
+#endif
@@ -0,0 +1,439 @@
+#ifndef READERRANGE_H
+#define READERRANGE_H
+
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "DSVReader.h"
+#include "DSVPushParser.h"
+#include "XMLReader.h"
+
+#if __cplusplus >= 202002L && __has_include(<ranges>)
+#include <ranges>
+#define READERRANGE_VIEW_BASE : public std::ranges::view_base
+#else
+#define READERRANGE_VIEW_BASE
+#endif
+
+// Lazy single pass range over a reader. Each step reads into one value held
+// by the range, so iterating hands out a reference to the same reused row or
+// entity instead of copying it; copy it out to keep it past the next step.
+// Under C++20 the range is a view and composes with std::views::filter,
+// std::views::take and the like.
+template <typename TReader, typename TValue, typename TRead>
+class CReaderRange READERRANGE_VIEW_BASE{
+    private:
+        TReader *DReader;
+        TRead DRead;
+        TValue DValue;
+        bool DDone;
+
+        void Advance(){
+            DDone = DDone || !DRead(*DReader, DValue);
+        };
+
+    public:
+        class CIterator{
+            private:
+                CReaderRange *DRange;   // null once past the end
+
+            public:
+                using iterator_category = std::input_iterator_tag;
+                using value_type = TValue;
+                using difference_type = std::ptrdiff_t;
+                using pointer = const TValue *;
+                using reference = const TValue &;
+
+                CIterator(CReaderRange *range = nullptr) : DRange(range){
+
+                };
+
+                reference operator*() const{
+                    return DRange->DValue;
+                };
+
+                pointer operator->() const{
+                    return &DRange->DValue;
+                };
+
+                CIterator &operator++(){
+                    DRange->Advance();
+                    if(DRange->DDone){
+                        DRange = nullptr;
+                    }
+                    return *this;
+                };
+
+                void operator++(int){
+                    ++*this;
+                };
+
+                bool operator==(const CIterator &other) const{
+                    return DRange == other.DRange;
+                };
+
+                bool operator!=(const CIterator &other) const{
+                    return DRange != other.DRange;
+                };
+        };
+
+        CReaderRange(TReader &reader, TRead read = TRead()) : DReader(&reader), DRead(read), DDone(false){
+
+        };
+
+        // Reads the first value, the range can only be iterated once
+        CIterator begin(){
+            Advance();
+            return DDone ? CIterator() : CIterator(this);
+        };
+
+        CIterator end(){
+            return CIterator();
+        };
+};
+
+struct SDSVRowRead{
+    bool operator()(CDSVReader &reader, std::vector< std::string > &row) const{
+        return reader.ReadRow(row);
+    };
+};
+
+struct SDSVPushRowRead{
+    bool operator()(CDSVPushParser &parser, std::vector< std::string > &row) const{
+        return parser.ReadRow(row);
+    };
+};
+
+struct SXMLEntityRead{
+    bool DSkipCData = false;
+
+    bool operator()(CXMLReader &reader, SXMLEntity &entity) const{
+        return reader.ReadEntity(entity, DSkipCData);
+    };
+};
+
+using CDSVRowRange = CReaderRange< CDSVReader, std::vector< std::string >, SDSVRowRead >;
+using CDSVPushRowRange = CReaderRange< CDSVPushParser, std::vector< std::string >, SDSVPushRowRead >;
+using CXMLEntityRange = CReaderRange< CXMLReader, SXMLEntity, SXMLEntityRead >;
+
+inline CDSVRowRange Rows(CDSVReader &reader){
+    return CDSVRowRange(reader);
+}
+
+// Rows the parser has completed so far, for use after each Feed
+inline CDSVPushRowRange Rows(CDSVPushParser &parser){
+    return CDSVPushRowRange(parser);
+}
+
+inline CXMLEntityRange Entities(CXMLReader &reader, bool skipcdata = false){
+    return CXMLEntityRange(reader, SXMLEntityRead{skipcdata});
+}
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+// Coroutine generator yielding references to values that live in the
+// coroutine frame, only available when compiled as C++20
+template <typename TValue>
+class CGenerator READERRANGE_VIEW_BASE{
+    public:
+        struct promise_type{
+            const TValue *DValue = nullptr;
+
+            CGenerator get_return_object(){
+                return CGenerator(std::coroutine_handle< promise_type >::from_promise(*this));
+            };
+
+            std::suspend_always initial_suspend() noexcept{
+                return {};
+            };
+
+            std::suspend_always final_suspend() noexcept{
+                return {};
+            };
+
+            std::suspend_always yield_value(const TValue &value) noexcept{
+                DValue = &value;
+                return {};
+            };
+
+            void return_void() noexcept{
+
+            };
+
+            void unhandled_exception(){
+                std::terminate();
+            };
+        };
+
+        using THandle = std::coroutine_handle< promise_type >;
+
+        class CIterator{
+            private:
+                THandle DHandle;    // null once past the end
+
+            public:
+                using iterator_category = std::input_iterator_tag;
+                using value_type = TValue;
+                using difference_type = std::ptrdiff_t;
+                using pointer = const TValue *;
+                using reference = const TValue &;
+
+                CIterator(THandle handle = nullptr) : DHandle(handle){
+
+                };
+
+                reference operator*() const{
+                    return *DHandle.promise().DValue;
+                };
+
+                pointer operator->() const{
+                    return DHandle.promise().DValue;
+                };
+
+                CIterator &operator++(){
+                    DHandle.resume();
+                    if(DHandle.done()){
+                        DHandle = nullptr;
+                    }
+                    return *this;
+                };
+
+                void operator++(int){
+                    ++*this;
+                };
+
+                bool operator==(const CIterator &other) const{
+                    return DHandle == other.DHandle;
+                };
+        };
+
+    private:
+        THandle DHandle;
+
+        explicit CGenerator(THandle handle) : DHandle(handle){
+
+        };
+
+    public:
+        CGenerator(CGenerator &&other) noexcept : DHandle(std::exchange(other.DHandle, nullptr)){
+
+        };
+
+        CGenerator &operator=(CGenerator &&other) noexcept{
+            std::swap(DHandle, other.DHandle);
+            return *this;
+        };
+
+        ~CGenerator(){
+            if(DHandle){
+                DHandle.destroy();
+            }
+        };
+
+        CIterator begin(){
+            DHandle.resume();
+            return DHandle.done() ? CIterator() : CIterator(DHandle);
+        };
+
+        CIterator end(){
+            return CIterator();
+        };
+};
+
+inline CGenerator< std::vector< std::string > > GenerateRows(CDSVReader &reader){
+    std::vector< std::string > Row;
+    while(reader.ReadRow(Row)){
+        co_yield Row;
+    }
+}
+
+// Yields the rows the parser has completed so far and then finishes, it
+// does not wait for more input; take a fresh generator after each Feed or use
+// GenerateRowsAsync
+inline CGenerator< std::vector< std::string > > GenerateRows(CDSVPushParser &parser){
+    std::vector< std::string > Row;
+    while(parser.ReadRow(Row)){
+        co_yield Row;
+    }
+}
+
+// Awaitable taking the next row of a push parser. co_await gives true with the
+// row read, or false once the input has ended and every row was read. With no
+// row ready the awaiting coroutine is suspended and resumed from inside the
+// Feed or Finish that completes one, on the thread making that call, so many
+// parsers can be served by whichever few threads feed them.
+class CDSVRowAwaitable{
+    private:
+        CDSVPushParser *DParser;
+        std::vector< std::string > *DRow;
+        bool DWaiting;
+
+    public:
+        CDSVRowAwaitable(CDSVPushParser &parser, std::vector< std::string > &row) : DParser(&parser), DRow(&row), DWaiting(false){
+
+        };
+
+        CDSVRowAwaitable(const CDSVRowAwaitable &) = delete;
+        CDSVRowAwaitable &operator=(const CDSVRowAwaitable &) = delete;
+
+        // a coroutine destroyed while waiting withdraws from the parser
+        ~CDSVRowAwaitable(){
+            if(DWaiting){
+                DParser->OnReady(nullptr);
+            }
+        };
+
+        bool await_ready() const{
+            return DParser->RowsReady() || DParser->End();
+        };
+
+        void await_suspend(std::coroutine_handle<> handle){
+            DWaiting = true;
+            DParser->OnReady([this, handle]{
+                DWaiting = false;
+                handle.resume();
+            });
+        };
+
+        bool await_resume(){
+            return DParser->ReadRow(*DRow);
+        };
+};
+
+inline CDSVRowAwaitable NextRow(CDSVPushParser &parser, std::vector< std::string > &row){
+    return CDSVRowAwaitable(parser, row);
+}
+
+// Coroutine generator whose body may itself suspend on co_await. A consumer
+// coroutine takes each value with co_await Next(), which gives a pointer to
+// the value living in the generator frame, or nullptr once the generator has
+// finished. Control passes straight between consumer and generator; when the
+// generator waits on its input both stay suspended until that input resumes
+// the generator.
+template <typename TValue>
+class CAsyncGenerator{
+    public:
+        struct promise_type{
+            const TValue *DValue = nullptr;
+            std::coroutine_handle<> DConsumer;
+
+            // hands control back to the consumer waiting in Next
+            struct SResumeConsumer{
+                bool await_ready() const noexcept{
+                    return false;
+                };
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle< promise_type > handle) noexcept{
+                    return handle.promise().DConsumer;
+                };
+
+                void await_resume() const noexcept{
+
+                };
+            };
+
+            CAsyncGenerator get_return_object(){
+                return CAsyncGenerator(std::coroutine_handle< promise_type >::from_promise(*this));
+            };
+
+            std::suspend_always initial_suspend() noexcept{
+                return {};
+            };
+
+            SResumeConsumer final_suspend() noexcept{
+                DValue = nullptr;
+                return {};
+            };
+
+            SResumeConsumer yield_value(const TValue &value) noexcept{
+                DValue = &value;
+                return {};
+            };
+
+            void return_void() noexcept{
+
+            };
+
+            void unhandled_exception(){
+                std::terminate();
+            };
+        };
+
+        using THandle = std::coroutine_handle< promise_type >;
+
+        class CNext{
+            private:
+                THandle DHandle;
+
+            public:
+                explicit CNext(THandle handle) : DHandle(handle){
+
+                };
+
+                bool await_ready() const noexcept{
+                    return !DHandle || DHandle.done();
+                };
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<> consumer) noexcept{
+                    DHandle.promise().DConsumer = consumer;
+                    return DHandle;
+                };
+
+                const TValue *await_resume() const noexcept{
+                    return await_ready() ? nullptr : DHandle.promise().DValue;
+                };
+        };
+
+    private:
+        THandle DHandle;
+
+        explicit CAsyncGenerator(THandle handle) : DHandle(handle){
+
+        };
+
+    public:
+        CAsyncGenerator(CAsyncGenerator &&other) noexcept : DHandle(std::exchange(other.DHandle, nullptr)){
+
+        };
+
+        CAsyncGenerator &operator=(CAsyncGenerator &&other) noexcept{
+            std::swap(DHandle, other.DHandle);
+            return *this;
+        };
+
+        ~CAsyncGenerator(){
+            if(DHandle){
+                DHandle.destroy();
+            }
+        };
+
+        // Resumes the generator up to its next value, only from a coroutine
+        CNext Next(){
+            return CNext(DHandle);
+        };
+};
+
+// Yields every row of the parser as it is fed, suspending while no row is
+// ready, and finishes after Finish once the last row was taken
+inline CAsyncGenerator< std::vector< std::string > > GenerateRowsAsync(CDSVPushParser &parser){
+    std::vector< std::string > Row;
+    while(co_await NextRow(parser, Row)){
+        co_yield Row;
+    }
+}
+
+inline CGenerator< SXMLEntity > GenerateEntities(CXMLReader &reader, bool skipcdata = false){
+    SXMLEntity Entity;
+    while(reader.ReadEntity(Entity, skipcdata)){
+        co_yield Entity;
+    }
+}
+#endif
+
+#undef READERRANGE_VIEW_BASE
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef SEGMENTEDDATASINK_H
+#define SEGMENTEDDATASINK_H
+
+#include "DataSink.h"
+#include "SharedBufferDataSource.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// In memory sink that stores its output as a list of fixed size segments
+// instead of one growing string, so written bytes are never moved again.
+// Segments() hands the segments out by reference count; a segment handed
+// out is never written again, later writes go to a fresh segment. Source()
+// gives a reader over everything written so far.
+class CSegmentedDataSink : public CDataSink{
+    private:
+        std::vector< std::shared_ptr< std::vector<char> > > DSegments;
+        std::size_t DSegmentSize;
+        std::size_t DSize;
+        bool DSealed;   // last segment has been handed out
+
+        std::vector<char> &Current();
+
+    public:
+        CSegmentedDataSink(std::size_t segmentsize = 65536);
+
+        std::size_t Size() const noexcept;
+        std::vector< CSharedBufferDataSource::TSegment > Segments();
+        std::shared_ptr< CSharedBufferDataSource > Source();
+        std::string String() const;
+
+        bool Put(const char &ch) noexcept override;
+        bool Write(const std::vector<char> &buf) noexcept override;
+};
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef SHARDEDDSVWRITER_H
+#define SHARDEDDSVWRITER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "DataSink.h"
+
+// Routes each row to one of the sinks by a hash of the key columns. Every
+// shard has its own worker thread that formats its rows through a CDSVWriter
+// into a buffer written to the sink in large blocks, so rows with the same
+// key values always land in the same sink in the order they were written.
+// Once a shard fails to write, WriteRow returns false for rows routed to it
+// until Flush reports the failure.
+class CShardedDSVWriter{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+        
+    public:
+        CShardedDSVWriter(std::vector< std::shared_ptr< CDataSink > > sinks, const std::vector< std::size_t > &keycolumns, char delimiter, bool quoteall = false);
+        ~CShardedDSVWriter();
+        
+        std::size_t ShardCount() const;
+        std::size_t ShardOf(const std::vector<std::string> &row) const;
+        std::size_t RowCount(std::size_t shard) const;
+        
+        bool WriteRow(const std::vector<std::string> &row);
+        bool Flush();
+};
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef SHAREDBUFFERDATASOURCE_H
+#define SHAREDBUFFERDATASOURCE_H
+
+#include "DataSource.h"
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Reads bytes held elsewhere without copying them up front. The bytes are
+// either borrowed, in which case the caller keeps them alive for the life of
+// the source, or shared through reference counted immutable buffers. A
+// source may span several segments, such as those of a CSegmentedDataSink.
+// Any number of sources can read the same buffers at once, each keeps its
+// own position.
+class CSharedBufferDataSource : public CDataSource{
+    public:
+        using TSegment = std::shared_ptr< const std::vector<char> >;
+
+    private:
+        std::vector< std::string_view > DSegments;
+        std::vector< std::shared_ptr< const void > > DOwners;  // keeps shared buffers alive
+        std::size_t DSegment;   // segment holding the next byte
+        std::size_t DIndex;     // offset of the next byte in that segment
+
+        void Normalize() noexcept;
+
+    public:
+        CSharedBufferDataSource(std::string_view borrowed);
+        CSharedBufferDataSource(std::shared_ptr< const std::string > buffer);
+        CSharedBufferDataSource(std::vector< TSegment > segments);
+
+        bool End() const noexcept override;
+        bool Get(char &ch) noexcept override;
+        bool Peek(char &ch) noexcept override;
+        bool Read(std::vector<char> &buf, std::size_t count) noexcept override;
+        bool Seek(std::size_t offset) noexcept override;
+};
+
+#endif
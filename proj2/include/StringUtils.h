@@ -1,8 +1,12 @@
 #ifndef STRINGUTILS_H
 #define STRINGUTILS_H
 
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
+#include "DataSink.h"
+#include "DataSource.h"
 
 namespace StringUtils{
     
@@ -22,6 +26,35 @@ std::string Join(const std::string &str, const std::vector< std::string > &vect)
 std::string ExpandTabs(const std::string &str, int tabsize = 4) noexcept;
 int EditDistance(const std::string &left, const std::string &right, bool ignorecase=false) noexcept;
 
+// In place ASCII case conversion, bytes outside A-Z/a-z are left unchanged
+void CapitalizeInPlace(std::string &str) noexcept;
+void UpperInPlace(std::string &str) noexcept;
+void LowerInPlace(std::string &str) noexcept;
+void CapitalizeInPlace(char *buf, std::size_t len) noexcept;
+void UpperInPlace(char *buf, std::size_t len) noexcept;
+void LowerInPlace(char *buf, std::size_t len) noexcept;
+
+// Applies a set of (old, new) replacements in one pass with an Aho-Corasick
+// automaton built once at construction. Where patterns overlap, the match
+// that starts first wins and, of those, the longest. Replacement text is not
+// scanned again. Empty patterns are ignored; for a repeated pattern the first
+// pair counts. Each input byte is fed to the automaton once, so the time is
+// linear in the input plus the number of pattern occurrences in it.
+class CMultiReplacer{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+        
+    public:
+        CMultiReplacer(const std::vector< std::pair< std::string, std::string > > &replacements);
+        ~CMultiReplacer();
+        
+        std::string Replace(const std::string &str) const noexcept;
+        bool Replace(CDataSource &src, CDataSink &sink) const noexcept;
+};
+
+std::string Replace(const std::string &str, const std::vector< std::pair< std::string, std::string > > &replacements) noexcept;
+
 }
 
 #endif
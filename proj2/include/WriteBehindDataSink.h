@@ -0,0 +1,25 @@
+#ifndef WRITEBEHINDDATASINK_H
+#define WRITEBEHINDDATASINK_H
+
+#include <memory>
+#include "DataSink.h"
+
+// Collects writes into buffers that a background thread passes on to the
+// wrapped sink. At most queuedepth filled buffers wait in the queue, after
+// that writers block until the sink catches up. A failed write to the wrapped
+// sink is reported by the following Put, Write or Flush.
+class CWriteBehindDataSink : public CDataSink{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+        
+    public:
+        CWriteBehindDataSink(std::shared_ptr< CDataSink > sink, std::size_t buffersize = 65536, std::size_t queuedepth = 8);
+        ~CWriteBehindDataSink();
+        
+        bool Put(const char &ch) noexcept override;
+        bool Write(const std::vector<char> &buf) noexcept override;
+        bool Flush() noexcept override;
+};
+
+#endif
@@ -3,7 +3,9 @@
 
 #include <utility>
 #include <string>
+#include <string_view>
 #include <vector>
+#include <memory_resource>
 
 struct SXMLEntity{
     using TAttribute = std::pair< std::string, std::string >;
@@ -44,5 +46,57 @@ struct SXMLEntity{
         return true;
     };
 };
+
+// SXMLEntity whose name, attributes and their strings are all allocated from
+// one memory resource, so a batch of entities can live in an arena
+struct SPmrXMLEntity{
+    using allocator_type = std::pmr::polymorphic_allocator< char >;
+    using TAttribute = std::pair< std::pmr::string, std::pmr::string >;
+    SXMLEntity::EType DType;
+    std::pmr::string DNameData;
+    std::pmr::vector< TAttribute > DAttributes;
+    
+    explicit SPmrXMLEntity(const allocator_type &alloc = allocator_type()) 
+        : DType(SXMLEntity::EType::StartElement), DNameData(alloc), DAttributes(alloc){
+    
+    };
+    
+    SPmrXMLEntity(const SPmrXMLEntity &other, const allocator_type &alloc) 
+        : DType(other.DType), DNameData(other.DNameData, alloc), DAttributes(other.DAttributes, alloc){
+    
+    };
+    
+    SPmrXMLEntity(SPmrXMLEntity &&other, const allocator_type &alloc) 
+        : DType(other.DType), DNameData(std::move(other.DNameData), alloc), DAttributes(std::move(other.DAttributes), alloc){
+    
+    };
+    
+    SPmrXMLEntity(const SPmrXMLEntity &other) = default;
+    SPmrXMLEntity(SPmrXMLEntity &&other) = default;
+    SPmrXMLEntity &operator=(const SPmrXMLEntity &other) = default;
+    SPmrXMLEntity &operator=(SPmrXMLEntity &&other) = default;
+    
+    allocator_type get_allocator() const{
+        return DNameData.get_allocator();
+    };
+    
+    bool AttributeExists(std::string_view name) const{
+        for(auto &Attribute : DAttributes){
+            if(std::get<0>(Attribute) == name){
+                return true;   
+            }
+        }
+        return false;
+    };
+    
+    std::string_view AttributeValue(std::string_view name) const{
+        for(auto &Attribute : DAttributes){
+            if(std::get<0>(Attribute) == name){
+                return std::get<1>(Attribute);   
+            }
+        }
+        return std::string_view();
+    };
+};
    
 #endif
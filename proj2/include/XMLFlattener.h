@@ -0,0 +1,49 @@
+#ifndef XMLFLATTENER_H
+#define XMLFLATTENER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "DataSource.h"
+#include "DSVWriter.h"
+
+// Where a DSV column takes its value from, relative to the record element
+struct SXMLFlattenColumn{
+    enum class EKind{Attribute, ChildText, ChildAttribute};
+    EKind DKind;
+    std::string DElement;   // child element name, unused for Attribute
+    std::string DAttribute; // attribute name, unused for ChildText
+    
+    static SXMLFlattenColumn Attribute(const std::string &name){
+        return SXMLFlattenColumn{EKind::Attribute, std::string(), name};
+    };
+    
+    static SXMLFlattenColumn ChildText(const std::string &element){
+        return SXMLFlattenColumn{EKind::ChildText, element, std::string()};
+    };
+    
+    static SXMLFlattenColumn ChildAttribute(const std::string &element, const std::string &name){
+        return SXMLFlattenColumn{EKind::ChildAttribute, element, name};
+    };
+};
+
+// Flattens every record element of an XML stream into one DSV row, reading
+// straight from the expat callbacks without building SXMLEntity values. The
+// column slots for each element name are worked out once up front. Nested
+// occurrences of the record element inside a record are treated as children.
+class CXMLFlattener{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+        
+    public:
+        CXMLFlattener(const std::string &record, const std::vector< SXMLFlattenColumn > &columns);
+        ~CXMLFlattener();
+        
+        std::vector< std::string > Header() const;
+        std::size_t RecordCount() const;
+        
+        bool Flatten(std::shared_ptr< CDataSource > src, CDSVWriter &writer, bool header = false);
+};
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef XMLHANDLER_H
+#define XMLHANDLER_H
+
+#include <string_view>
+#include <vector>
+
+// Element or attribute name. DNamespace is the namespace URI when the reader
+// is namespace aware and the name is in a namespace, otherwise it is empty
+// and DLocal holds the name as written.
+struct SXMLName{
+    std::string_view DNamespace;
+    std::string_view DLocal;
+};
+
+struct SXMLAttributeView{
+    SXMLName DName;
+    std::string_view DValue;
+};
+
+// Receives events straight from the parser. The views only remain valid for
+// the duration of the call.
+class CXMLHandler{
+    public:
+        virtual ~CXMLHandler(){};
+        virtual void StartElement(const SXMLName &name, const std::vector< SXMLAttributeView > &attributes){ (void)name; (void)attributes; };
+        virtual void EndElement(const SXMLName &name){ (void)name; };
+        virtual void CharData(std::string_view data){ (void)data; };
+};
+
+#endif
@@ -4,6 +4,7 @@
 #include <memory>
 #include "XMLEntity.h"
 #include "DataSource.h"
+#include "XMLHandler.h"
 
 class CXMLReader{
     private:
@@ -11,11 +12,13 @@ class CXMLReader{
         std::unique_ptr<SImplementation> DImplementation;
         
     public:
-        CXMLReader(std::shared_ptr< CDataSource > src);
+        CXMLReader(std::shared_ptr< CDataSource > src, bool namespaces = false);
         ~CXMLReader();
         
         bool End() const;
         bool ReadEntity(SXMLEntity &entity, bool skipcdata = false);
+        bool ReadEntity(SPmrXMLEntity &entity, bool skipcdata = false);
+        bool Parse(CXMLHandler &handler, bool skipcdata = false);
 };
 
 #endif
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define XMLWRITER_H
 
 #include <memory>
+#include <string_view>
 #include "XMLEntity.h"
 #include "DataSink.h"
 
@@ -16,6 +17,11 @@ class CXMLWriter{
         
         bool Flush();
         bool WriteEntity(const SXMLEntity &entity);
+        
+        bool StartElement(std::string_view name);
+        bool Attribute(std::string_view name, std::string_view value);
+        bool Text(std::string_view text);
+        bool EndElement();
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,312 @@
+#include "BinarySpill.h"
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+namespace{
+
+constexpr char SpillMagic[] = {'S', 'P', 'L', '1'};
+constexpr std::size_t SpillMagicSize = sizeof(SpillMagic);
+constexpr unsigned char DictionaryFlag = 0x01;
+constexpr unsigned char EntityTag = 0x01;
+constexpr unsigned char RowTag = 0x02;
+constexpr std::size_t MaxNames = 65536;     // dictionary stops growing here
+constexpr std::size_t BlockSize = 65536;
+
+}
+
+// Names go out as a varint whose low bit tells a dictionary index (set) from
+// the length of a literal name (clear). A literal name gets the next index
+// while the dictionary is below MaxNames, the reader grows its copy the same
+// way so no table is stored.
+struct CBinarySpillWriter::SImplementation{
+    std::shared_ptr< CDataSink > DSink;
+    bool DDictionary;
+    std::unordered_map< std::string, std::uint64_t > DNames;
+    std::vector< char > DBuffer;
+    bool DValid;
+
+    SImplementation(std::shared_ptr< CDataSink > sink, bool dictionary)
+        : DSink(std::move(sink)), DDictionary(dictionary), DValid(true){
+        DBuffer.reserve(BlockSize + BlockSize / 4);
+        DBuffer.insert(DBuffer.end(), SpillMagic, SpillMagic + SpillMagicSize);
+        DBuffer.push_back(static_cast<char>(dictionary ? DictionaryFlag : 0));
+    };
+
+    void PutVarint(std::uint64_t value){
+        while(value >= 0x80){
+            DBuffer.push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        DBuffer.push_back(static_cast<char>(value));
+    };
+
+    void PutString(const std::string &str){
+        PutVarint(str.size());
+        DBuffer.insert(DBuffer.end(), str.begin(), str.end());
+    };
+
+    void PutName(const std::string &name){
+        if(!DDictionary){
+            PutString(name);
+            return;
+        }
+        auto Found = DNames.find(name);
+        if(Found != DNames.end()){
+            PutVarint((Found->second << 1) | 1);
+            return;
+        }
+        if(DNames.size() < MaxNames){
+            DNames.emplace(name, DNames.size());
+        }
+        PutVarint(static_cast<std::uint64_t>(name.size()) << 1);
+        DBuffer.insert(DBuffer.end(), name.begin(), name.end());
+    };
+
+    bool Spill(){
+        if(!DBuffer.empty()){
+            DValid = DSink->Write(DBuffer) && DValid;
+            DBuffer.clear();
+        }
+        return DValid;
+    };
+
+    bool EndRecord(){
+        return DBuffer.size() < BlockSize ? DValid : Spill();
+    };
+};
+
+CBinarySpillWriter::CBinarySpillWriter(std::shared_ptr< CDataSink > sink, bool dictionary) : DImplementation(std::make_unique<SImplementation>(std::move(sink), dictionary)){
+
+}
+
+// Buffered records are written to the sink, the sink itself is not flushed
+CBinarySpillWriter::~CBinarySpillWriter(){
+    DImplementation->Spill();
+}
+
+bool CBinarySpillWriter::WriteEntity(const SXMLEntity &entity){
+    DImplementation->DBuffer.push_back(static_cast<char>(EntityTag));
+    DImplementation->DBuffer.push_back(static_cast<char>(entity.DType));
+    if(entity.DType == SXMLEntity::EType::CharData){
+        DImplementation->PutString(entity.DNameData);
+    }
+    else{
+        DImplementation->PutName(entity.DNameData);
+    }
+    DImplementation->PutVarint(entity.DAttributes.size());
+    for(auto &Attribute : entity.DAttributes){
+        DImplementation->PutName(Attribute.first);
+        DImplementation->PutString(Attribute.second);
+    }
+    return DImplementation->EndRecord();
+}
+
+bool CBinarySpillWriter::WriteRow(const std::vector< std::string > &row){
+    DImplementation->DBuffer.push_back(static_cast<char>(RowTag));
+    DImplementation->PutVarint(row.size());
+    for(auto &Value : row){
+        DImplementation->PutString(Value);
+    }
+    return DImplementation->EndRecord();
+}
+
+// Writes buffered records and flushes the sink, false if any write failed
+bool CBinarySpillWriter::Flush(){
+    return DImplementation->Spill() && DImplementation->DSink->Flush();
+}
+
+struct CBinarySpillReader::SImplementation{
+    std::shared_ptr< CDataSource > DSource;
+    std::vector< char > DBuffer;
+    std::vector< char > DChunk;
+    std::size_t DIndex;
+    std::vector< std::string > DNames;
+    bool DStarted;
+    bool DDictionary;
+    bool DError;
+
+    SImplementation(std::shared_ptr< CDataSource > src)
+        : DSource(std::move(src)), DIndex(0), DStarted(false), DDictionary(false), DError(false){
+
+    };
+
+    // Makes sure count unread bytes are buffered
+    bool Need(std::size_t count){
+        while(DBuffer.size() - DIndex < count){
+            if(DIndex){
+                DBuffer.erase(DBuffer.begin(), DBuffer.begin() + DIndex);
+                DIndex = 0;
+            }
+            if(!DSource->Read(DChunk, BlockSize)){
+                return false;
+            }
+            DBuffer.insert(DBuffer.end(), DChunk.begin(), DChunk.end());
+        }
+        return true;
+    };
+
+    bool Fail(){
+        DError = true;
+        return false;
+    };
+
+    bool Start(){
+        DStarted = true;
+        if(!Need(SpillMagicSize + 1) || std::memcmp(DBuffer.data(), SpillMagic, SpillMagicSize)){
+            return Fail();
+        }
+        DDictionary = DBuffer[SpillMagicSize] & DictionaryFlag;
+        DIndex = SpillMagicSize + 1;
+        return true;
+    };
+
+    bool GetByte(unsigned char &byte){
+        if(!Need(1)){
+            return Fail();
+        }
+        byte = static_cast<unsigned char>(DBuffer[DIndex++]);
+        return true;
+    };
+
+    bool GetVarint(std::uint64_t &value){
+        value = 0;
+        for(int Shift = 0; Shift < 64; Shift += 7){
+            unsigned char Byte;
+            if(!GetByte(Byte)){
+                return false;
+            }
+            value |= static_cast<std::uint64_t>(Byte & 0x7F) << Shift;
+            if(!(Byte & 0x80)){
+                return true;
+            }
+        }
+        return Fail();
+    };
+
+    bool GetBytes(std::string &str, std::uint64_t length){
+        if(!Need(length)){
+            return Fail();
+        }
+        str.assign(DBuffer.data() + DIndex, length);
+        DIndex += length;
+        return true;
+    };
+
+    bool GetString(std::string &str){
+        std::uint64_t Length;
+        return GetVarint(Length) && GetBytes(str, Length);
+    };
+
+    bool GetName(std::string &name){
+        if(!DDictionary){
+            return GetString(name);
+        }
+        std::uint64_t Value;
+        if(!GetVarint(Value)){
+            return false;
+        }
+        if(Value & 1){
+            if((Value >> 1) >= DNames.size()){
+                return Fail();
+            }
+            name = DNames[Value >> 1];
+            return true;
+        }
+        if(!GetBytes(name, Value >> 1)){
+            return false;
+        }
+        if(DNames.size() < MaxNames){
+            DNames.push_back(name);
+        }
+        return true;
+    };
+
+    ESpillRecord Next(){
+        if(DError || (!DStarted && !Start())){
+            return ESpillRecord::Error;
+        }
+        if(!Need(1)){
+            return ESpillRecord::End;
+        }
+        switch(static_cast<unsigned char>(DBuffer[DIndex])){
+            case EntityTag: return ESpillRecord::Entity;
+            case RowTag:    return ESpillRecord::Row;
+            default:        Fail();
+                            return ESpillRecord::Error;
+        }
+    };
+};
+
+CBinarySpillReader::CBinarySpillReader(std::shared_ptr< CDataSource > src) : DImplementation(std::make_unique<SImplementation>(std::move(src))){
+
+}
+
+CBinarySpillReader::~CBinarySpillReader(){
+
+}
+
+// True when no further record can be read, at the end or after an error
+bool CBinarySpillReader::End(){
+    ESpillRecord Record = DImplementation->Next();
+    return Record == ESpillRecord::End || Record == ESpillRecord::Error;
+}
+
+// Type of the next record without consuming it
+ESpillRecord CBinarySpillReader::Next(){
+    return DImplementation->Next();
+}
+
+// Reads the next record if it is an entity, strings already held by entity
+// are reused
+bool CBinarySpillReader::ReadEntity(SXMLEntity &entity){
+    if(DImplementation->Next() != ESpillRecord::Entity){
+        return false;
+    }
+    DImplementation->DIndex++;
+    unsigned char Type;
+    if(!DImplementation->GetByte(Type) || Type > static_cast<unsigned char>(SXMLEntity::EType::CompleteElement)){
+        return DImplementation->Fail();
+    }
+    entity.DType = static_cast<SXMLEntity::EType>(Type);
+    bool Success = entity.DType == SXMLEntity::EType::CharData ? DImplementation->GetString(entity.DNameData) : DImplementation->GetName(entity.DNameData);
+    std::uint64_t Count;
+    if(!Success || !DImplementation->GetVarint(Count)){
+        return false;
+    }
+    // grown one at a time so a corrupt count cannot allocate ahead of the data
+    std::size_t Index = 0;
+    for(; Index < Count; Index++){
+        if(Index == entity.DAttributes.size()){
+            entity.DAttributes.emplace_back();
+        }
+        if(!DImplementation->GetName(entity.DAttributes[Index].first) || !DImplementation->GetString(entity.DAttributes[Index].second)){
+            return false;
+        }
+    }
+    entity.DAttributes.resize(Index);
+    return true;
+}
+
+// Reads the next record if it is a row, strings already held by row are reused
+bool CBinarySpillReader::ReadRow(std::vector< std::string > &row){
+    if(DImplementation->Next() != ESpillRecord::Row){
+        return false;
+    }
+    DImplementation->DIndex++;
+    std::uint64_t Count;
+    if(!DImplementation->GetVarint(Count)){
+        return false;
+    }
+    std::size_t Index = 0;
+    for(; Index < Count; Index++){
+        if(Index == row.size()){
+            row.emplace_back();
+        }
+        if(!DImplementation->GetString(row[Index])){
+            return false;
+        }
+    }
+    row.resize(Index);
+    return true;
+}
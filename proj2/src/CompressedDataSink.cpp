@@ -0,0 +1,188 @@
+#include "CompressedDataSink.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <zlib.h>
+
+struct CCompressedDataSink::SImplementation{
+    static constexpr std::size_t DChunkSize = 65536;
+    static constexpr std::size_t DMaxPending = 4;
+    
+    // Unit of work for the compressor, finish ends the current stream
+    struct SBlock{
+        std::vector<char> DData;
+        bool DFinish;
+    };
+    
+    std::shared_ptr< CDataSink > DSink;
+    ECompressionFormat DFormat;
+    z_stream DStream;
+    bool DStreamOpen;
+    std::atomic<bool> DError;
+    bool DDirty;                // data written since the stream was finished
+    std::vector<char> DInput;   // uncompressed bytes not yet handed off
+    std::vector<char> DOut;
+    
+    bool DBackground;
+    std::thread DWorker;
+    std::mutex DMutex;
+    std::condition_variable DCondition;
+    std::deque<SBlock> DPending;
+    bool DBusy;
+    bool DStop;
+    
+    SImplementation(std::shared_ptr< CDataSink > sink, ECompressionFormat format, int level, bool background) 
+        : DSink(std::move(sink)), DFormat(format), DStream(), DStreamOpen(false), DError(false), DDirty(false), 
+          DBackground(background), DBusy(false), DStop(false){
+        if(DFormat == ECompressionFormat::Gzip || DFormat == ECompressionFormat::Zlib){
+            int WindowBits = DFormat == ECompressionFormat::Gzip ? 15 + 16 : 15;
+            DStreamOpen = deflateInit2(&DStream, level, Z_DEFLATED, WindowBits, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+            DError = !DStreamOpen;
+        }
+        else if(DFormat != ECompressionFormat::None){
+            // no zstd encoder is linked in
+            DError = true;
+        }
+        DInput.reserve(DChunkSize);
+        if(DBackground && !DError){
+            DWorker = std::thread([this]{ WorkerLoop(); });
+        }
+    }
+    
+    ~SImplementation(){
+        if(DDirty){
+            Flush();
+        }
+        if(DWorker.joinable()){
+            {
+                std::lock_guard<std::mutex> Lock(DMutex);
+                DStop = true;
+            }
+            DCondition.notify_all();
+            DWorker.join();
+        }
+        if(DStreamOpen){
+            deflateEnd(&DStream);
+        }
+    }
+    
+    // Runs the compressor over data and writes whatever it produces
+    bool Compress(const std::vector<char> &data, bool finish){
+        if(DFormat == ECompressionFormat::None){
+            return data.empty() || DSink->Write(data);
+        }
+        DStream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+        DStream.avail_in = static_cast<uInt>(data.size());
+        int Flush = finish ? Z_FINISH : Z_NO_FLUSH;
+        int Result;
+        do{
+            DOut.resize(DChunkSize);
+            DStream.next_out = reinterpret_cast<Bytef *>(DOut.data());
+            DStream.avail_out = static_cast<uInt>(DOut.size());
+            Result = deflate(&DStream, Flush);
+            if(Result == Z_STREAM_ERROR){
+                return false;
+            }
+            DOut.resize(DOut.size() - DStream.avail_out);
+            if(!DOut.empty() && !DSink->Write(DOut)){
+                return false;
+            }
+        }while(DStream.avail_out == 0 || (finish && Result != Z_STREAM_END));
+        if(finish){
+            deflateReset(&DStream);
+        }
+        return true;
+    }
+    
+    void WorkerLoop(){
+        std::unique_lock<std::mutex> Lock(DMutex);
+        while(true){
+            DCondition.wait(Lock, [this]{ return DStop || !DPending.empty(); });
+            if(DPending.empty()){
+                return;
+            }
+            SBlock Block = std::move(DPending.front());
+            DPending.pop_front();
+            DBusy = true;
+            Lock.unlock();
+            DCondition.notify_all();
+            bool Success = Compress(Block.DData, Block.DFinish) && (!Block.DFinish || DSink->Flush());
+            Lock.lock();
+            DError = DError || !Success;
+            DBusy = false;
+            DCondition.notify_all();
+        }
+    }
+    
+    // Hands the buffered input to the compressor, inline or on the worker
+    bool Submit(bool finish){
+        if(DError){
+            return false;
+        }
+        if(!DBackground){
+            bool Success = Compress(DInput, finish) && (!finish || DSink->Flush());
+            DInput.clear();
+            DError = !Success;
+            return Success;
+        }
+        std::vector<char> Data;
+        Data.reserve(DChunkSize);
+        Data.swap(DInput);
+        std::unique_lock<std::mutex> Lock(DMutex);
+        DCondition.wait(Lock, [this]{ return DPending.size() < DMaxPending; });
+        DPending.push_back(SBlock{std::move(Data), finish});
+        Lock.unlock();
+        DCondition.notify_all();
+        return true;
+    }
+    
+    bool Append(const char *data, std::size_t length){
+        if(DError){
+            return false;
+        }
+        DDirty = true;
+        DInput.insert(DInput.end(), data, data + length);
+        if(DInput.size() >= DChunkSize){
+            return Submit(false);
+        }
+        return true;
+    }
+    
+    bool Flush(){
+        if(!DDirty){
+            return !DError && DSink->Flush();
+        }
+        DDirty = false;
+        if(!Submit(true)){
+            return false;
+        }
+        if(DBackground){
+            std::unique_lock<std::mutex> Lock(DMutex);
+            DCondition.wait(Lock, [this]{ return DPending.empty() && !DBusy; });
+        }
+        return !DError;
+    }
+};
+
+CCompressedDataSink::CCompressedDataSink(std::shared_ptr< CDataSink > sink, ECompressionFormat format, int level, bool background) 
+    : DImplementation(std::make_unique<SImplementation>(std::move(sink), format, level, background)){
+
+}
+
+CCompressedDataSink::~CCompressedDataSink(){
+
+}
+
+bool CCompressedDataSink::Put(const char &ch) noexcept{
+    return DImplementation->Append(&ch, 1);
+}
+
+bool CCompressedDataSink::Write(const std::vector<char> &buf) noexcept{
+    return DImplementation->Append(buf.data(), buf.size());
+}
+
+bool CCompressedDataSink::Flush() noexcept{
+    return DImplementation->Flush();
+}
@@ -0,0 +1,228 @@
+#include "CompressedDataSource.h"
+#include <algorithm>
+#include <zlib.h>
+
+struct CCompressedDataSource::SImplementation{
+    static constexpr std::size_t DChunkSize = 65536;
+    static constexpr std::size_t DMagicSize = 4;    // longest magic, zstd
+    
+    std::shared_ptr< CDataSource > DSource;
+    ECompressionFormat DFormat;
+    z_stream DStream;
+    bool DDetected;     // first bytes examined
+    bool DStreamOpen;   // inflate initialized
+    bool DStreamDone;   // no more output will be produced
+    bool DError;
+    bool DPendingOutput; // last inflate filled its buffer, more may follow
+    std::vector<char> DIn;
+    std::vector<char> DOut;
+    std::size_t DOutIndex;
+    
+    SImplementation(std::shared_ptr< CDataSource > src) 
+        : DSource(std::move(src)), DFormat(ECompressionFormat::None), DStream(), DDetected(false), 
+          DStreamOpen(false), DStreamDone(false), DError(false), DPendingOutput(false), DOutIndex(0){
+    
+    }
+    
+    ~SImplementation(){
+        if(DStreamOpen){
+            inflateEnd(&DStream);
+        }
+    }
+    
+    // Pulls the next chunk of compressed input, false if source is drained
+    bool ReadInput(){
+        if(!DSource->Read(DIn, DChunkSize)){
+            return false;
+        }
+        DStream.next_in = reinterpret_cast<Bytef *>(DIn.data());
+        DStream.avail_in = static_cast<uInt>(DIn.size());
+        return true;
+    }
+    
+    // Tops the first chunk up to length bytes, the source may hand them over
+    // in short reads. False if the source is drained without any bytes.
+    bool Gather(std::size_t length){
+        std::vector<char> Buffer;
+        while(DIn.size() < length && DSource->Read(Buffer, length - DIn.size())){
+            DIn.insert(DIn.end(), Buffer.begin(), Buffer.end());
+        }
+        DStream.next_in = reinterpret_cast<Bytef *>(DIn.data());
+        DStream.avail_in = static_cast<uInt>(DIn.size());
+        return !DIn.empty();
+    }
+    
+    // A zlib header is two bytes plain text can also start with, so the first
+    // chunk is inflated on the side and is passed through if that fails
+    bool InflatesCleanly(){
+        z_stream Trial = z_stream();
+        if(inflateInit(&Trial) != Z_OK){
+            return false;
+        }
+        std::vector<char> Scratch(DChunkSize);
+        Trial.next_in = reinterpret_cast<Bytef *>(DIn.data());
+        Trial.avail_in = static_cast<uInt>(DIn.size());
+        int Result;
+        do{
+            Trial.next_out = reinterpret_cast<Bytef *>(Scratch.data());
+            Trial.avail_out = static_cast<uInt>(Scratch.size());
+            Result = inflate(&Trial, Z_NO_FLUSH);
+        }while(Result == Z_OK && Trial.avail_in);
+        inflateEnd(&Trial);
+        if(Result == Z_STREAM_END){
+            return true;
+        }
+        // a stream cut short by the end of the chunk is fine if more follows
+        return (Result == Z_OK || Result == Z_BUF_ERROR) && !DSource->End();
+    }
+    
+    // Looks at the magic bytes of the first chunk to pick the format
+    void Detect(){
+        DDetected = true;
+        if(!Gather(DMagicSize)){
+            DStreamDone = true;
+            return;
+        }
+        const unsigned char *Magic = reinterpret_cast<const unsigned char *>(DIn.data());
+        std::size_t Length = DIn.size();
+        bool ZlibHeader = Length >= 2 && (Magic[0] & 0x0F) == 8 && (Magic[0] >> 4) <= 7 && !(Magic[1] & 0x20) && ((Magic[0] << 8) | Magic[1]) % 31 == 0;
+        if(ZlibHeader){
+            // the trial inflate needs a full chunk to tell text from zlib
+            Gather(DChunkSize);
+            Magic = reinterpret_cast<const unsigned char *>(DIn.data());
+        }
+        if(Length >= 2 && Magic[0] == 0x1F && Magic[1] == 0x8B){
+            DFormat = ECompressionFormat::Gzip;
+        }
+        else if(Length >= 4 && Magic[0] == 0x28 && Magic[1] == 0xB5 && Magic[2] == 0x2F && Magic[3] == 0xFD){
+            // zstd frames are recognized but no decoder is linked in
+            DFormat = ECompressionFormat::Zstd;
+            DError = true;
+            DStreamDone = true;
+            return;
+        }
+        else if(ZlibHeader && InflatesCleanly()){
+            // deflate method, window of at most 32K, no preset dictionary
+            DFormat = ECompressionFormat::Zlib;
+        }
+        if(DFormat == ECompressionFormat::None){
+            DOut.swap(DIn);
+            DOutIndex = 0;
+            return;
+        }
+        if(inflateInit2(&DStream, DFormat == ECompressionFormat::Gzip ? 15 + 16 : 15) != Z_OK){
+            DError = true;
+            DStreamDone = true;
+            return;
+        }
+        DStreamOpen = true;
+    }
+    
+    // Makes sure decompressed data is available, false at end of stream
+    bool Fill(){
+        if(DOutIndex < DOut.size()){
+            return true;
+        }
+        if(!DDetected){
+            Detect();
+            if(DOutIndex < DOut.size()){
+                return true;
+            }
+        }
+        while(!DStreamDone){
+            if(DFormat == ECompressionFormat::None){
+                DOutIndex = 0;
+                if(!DSource->Read(DOut, DChunkSize)){
+                    DStreamDone = true;
+                    return false;
+                }
+                return true;
+            }
+            if(DStream.avail_in == 0 && !DPendingOutput && !ReadInput()){
+                // truncated input
+                DError = true;
+                DStreamDone = true;
+                break;
+            }
+            DOut.resize(DChunkSize);
+            DOutIndex = 0;
+            DStream.next_out = reinterpret_cast<Bytef *>(DOut.data());
+            DStream.avail_out = static_cast<uInt>(DOut.size());
+            int Result = inflate(&DStream, Z_NO_FLUSH);
+            DPendingOutput = DStream.avail_out == 0;
+            DOut.resize(DOut.size() - DStream.avail_out);
+            if(Result == Z_STREAM_END){
+                // concatenated gzip members or zlib streams, as the sink
+                // writes after each Flush, continue the same stream; anything
+                // else after the end fails to inflate and sets the error
+                if(DStream.avail_in || ReadInput()){
+                    inflateReset(&DStream);
+                }
+                else{
+                    DStreamDone = true;
+                }
+            }
+            else if(Result != Z_OK && Result != Z_BUF_ERROR){
+                DError = true;
+                DStreamDone = true;
+            }
+            if(!DOut.empty()){
+                return true;
+            }
+        }
+        DOut.clear();
+        DOutIndex = 0;
+        return false;
+    }
+};
+
+CCompressedDataSource::CCompressedDataSource(std::shared_ptr< CDataSource > src) 
+    : DImplementation(std::make_unique<SImplementation>(std::move(src))){
+
+}
+
+CCompressedDataSource::~CCompressedDataSource(){
+
+}
+
+ECompressionFormat CCompressedDataSource::Format() const noexcept{
+    if(!DImplementation->DDetected){
+        DImplementation->Fill();
+    }
+    return DImplementation->DFormat;
+}
+
+bool CCompressedDataSource::Error() const noexcept{
+    return DImplementation->DError;
+}
+
+bool CCompressedDataSource::End() const noexcept{
+    return !DImplementation->Fill();
+}
+
+bool CCompressedDataSource::Get(char &ch) noexcept{
+    if(!DImplementation->Fill()){
+        return false;
+    }
+    ch = DImplementation->DOut[DImplementation->DOutIndex++];
+    return true;
+}
+
+bool CCompressedDataSource::Peek(char &ch) noexcept{
+    if(!DImplementation->Fill()){
+        return false;
+    }
+    ch = DImplementation->DOut[DImplementation->DOutIndex];
+    return true;
+}
+
+bool CCompressedDataSource::Read(std::vector<char> &buf, std::size_t count) noexcept{
+    buf.clear();
+    while(buf.size() < count && DImplementation->Fill()){
+        auto &Impl = *DImplementation;
+        std::size_t Length = std::min(count - buf.size(), Impl.DOut.size() - Impl.DOutIndex);
+        buf.insert(buf.end(), Impl.DOut.begin() + Impl.DOutIndex, Impl.DOut.begin() + Impl.DOutIndex + Length);
+        Impl.DOutIndex += Length;
+    }
+    return !buf.empty();
+}
@@ -0,0 +1,467 @@
+#include "DSVAggregator.h"
+#include "DSVReaderT.h"
+#include <algorithm>
+#include <charconv>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+namespace{
+
+constexpr std::size_t NotSelected = static_cast<std::size_t>(-1);
+
+// Aggregated column value of one row
+struct SValue{
+    bool DValid = false;
+    std::int64_t DInteger = 0;
+    double DDouble = 0.0;
+};
+
+// Running state of one aggregate of one group, DCount is the number of rows
+// for Count and the number of values used otherwise
+struct SAccumulator{
+    std::int64_t DCount = 0;
+    std::int64_t DInteger = 0;
+    double DDouble = 0.0;
+    bool DOverflow = false;     // integer total left the range of int64
+};
+
+// FNV-1a over the encoded key
+std::uint64_t HashKey(std::string_view key){
+    std::uint64_t Hash = 14695981039346656037ULL;
+    for(unsigned char Ch : key){
+        Hash = (Hash ^ Ch) * 1099511628211ULL;
+    }
+    return Hash;
+}
+
+// False if an integer total overflowed, total is then meaningless
+template <typename TValue>
+bool Combine(EDSVAggregateFunction function, bool first, TValue &total, TValue value){
+    if(function == EDSVAggregateFunction::Min){
+        total = first ? value : std::min(total, value);
+    }
+    else if(function == EDSVAggregateFunction::Max){
+        total = first ? value : std::max(total, value);
+    }
+    else if constexpr(std::is_integral< TValue >::value){
+        return !__builtin_add_overflow(total, value, &total);
+    }
+    else{
+        total += value;
+    }
+    return true;
+}
+
+// Rows scanned by the caller on their way to one partition
+struct SBatch{
+    std::string DKeys;                          // encoded keys back to back
+    std::vector< std::size_t > DKeyEnds;
+    std::vector< std::uint64_t > DHashes;
+    std::vector< std::uint64_t > DSequences;
+    std::vector< SValue > DValues;              // one per aggregate per row
+
+    std::size_t Size() const{
+        return DHashes.size();
+    };
+
+    void Clear(){
+        DKeys.clear();
+        DKeyEnds.clear();
+        DHashes.clear();
+        DSequences.clear();
+        DValues.clear();
+    };
+};
+
+// Open addressing table with linear probing. Slots hold a group number plus
+// one, key bytes live in one arena and accumulators in one flat vector, so a
+// group costs no allocation of its own.
+class CGroupTable{
+    private:
+        const std::vector< SDSVAggregate > *DAggregates;
+        std::vector< std::size_t > DSlots;
+        unsigned DBits;
+        std::string DKeys;
+        std::vector< std::size_t > DKeyEnds;
+
+        std::size_t SlotOf(std::uint64_t hash) const{
+            return (hash * 11400714819323198485ULL) >> (64 - DBits);
+        };
+
+        void Grow(){
+            DBits++;
+            DSlots.assign(std::size_t(1) << DBits, 0);
+            for(std::size_t Group = 0; Group < DHashes.size(); Group++){
+                std::size_t Slot = SlotOf(DHashes[Group]);
+                while(DSlots[Slot]){
+                    Slot = (Slot + 1) & (DSlots.size() - 1);
+                }
+                DSlots[Slot] = Group + 1;
+            }
+        };
+
+    public:
+        std::vector< std::uint64_t > DHashes;
+        std::vector< std::uint64_t > DSequences;    // row that started the group
+        std::vector< SAccumulator > DAccumulators;
+        bool DOverflow = false;     // some group's integer total overflowed
+
+        CGroupTable(const std::vector< SDSVAggregate > &aggregates) : DAggregates(&aggregates), DSlots(std::size_t(1) << 10, 0), DBits(10){
+
+        };
+
+        std::size_t Size() const{
+            return DHashes.size();
+        };
+
+        std::string_view Key(std::size_t group) const{
+            std::size_t Start = group ? DKeyEnds[group - 1] : 0;
+            return std::string_view(DKeys).substr(Start, DKeyEnds[group] - Start);
+        };
+
+        void Add(std::string_view key, std::uint64_t hash, std::uint64_t sequence, const SValue *values){
+            std::size_t Slot = SlotOf(hash);
+            std::size_t Group;
+            while(true){
+                if(!DSlots[Slot]){
+                    Group = DHashes.size();
+                    DSlots[Slot] = Group + 1;
+                    DKeys.append(key);
+                    DKeyEnds.push_back(DKeys.size());
+                    DHashes.push_back(hash);
+                    DSequences.push_back(sequence);
+                    DAccumulators.resize(DAccumulators.size() + DAggregates->size());
+                    break;
+                }
+                Group = DSlots[Slot] - 1;
+                if(DHashes[Group] == hash && Key(Group) == key){
+                    break;
+                }
+                Slot = (Slot + 1) & (DSlots.size() - 1);
+            }
+            SAccumulator *Accumulators = DAccumulators.data() + Group * DAggregates->size();
+            for(std::size_t Index = 0; Index < DAggregates->size(); Index++){
+                const SDSVAggregate &Aggregate = (*DAggregates)[Index];
+                SAccumulator &Accumulator = Accumulators[Index];
+                if(Aggregate.DFunction == EDSVAggregateFunction::Count){
+                    Accumulator.DCount++;
+                }
+                else if(values[Index].DValid){
+                    if(Aggregate.DType == EDSVAggregateType::Integer){
+                        if(!Accumulator.DOverflow && !Combine(Aggregate.DFunction, !Accumulator.DCount, Accumulator.DInteger, values[Index].DInteger)){
+                            Accumulator.DOverflow = true;
+                            DOverflow = true;
+                        }
+                    }
+                    else{
+                        Combine(Aggregate.DFunction, !Accumulator.DCount, Accumulator.DDouble, values[Index].DDouble);
+                    }
+                    Accumulator.DCount++;
+                }
+            }
+            // keep the load at or below one half
+            if(DHashes.size() * 2 > DSlots.size()){
+                Grow();
+            }
+        };
+
+        void Add(const SBatch &batch){
+            std::size_t Start = 0;
+            for(std::size_t Row = 0; Row < batch.Size(); Row++){
+                std::string_view Key = std::string_view(batch.DKeys).substr(Start, batch.DKeyEnds[Row] - Start);
+                Add(Key, batch.DHashes[Row], batch.DSequences[Row], batch.DValues.data() + Row * DAggregates->size());
+                Start = batch.DKeyEnds[Row];
+            }
+        };
+};
+
+std::string FormatDouble(double value){
+    char Buffer[64];
+    auto Result = std::to_chars(Buffer, Buffer + sizeof(Buffer), value);
+    return std::string(Buffer, Result.ptr);
+}
+
+}
+
+struct CDSVAggregator::SImplementation{
+    static constexpr std::size_t DBatchSize = 1024;     // rows handed over at once
+    static constexpr std::size_t DMaxBatches = 8;       // queued batches per partition
+
+    // One hash partition, its table is only touched by its worker while a
+    // parallel Consume runs
+    struct SPartition{
+        CGroupTable DTable;
+        SBatch DFilling;
+        std::deque< SBatch > DQueue;
+        std::vector< SBatch > DSpare;
+        bool DDone = false;
+        std::mutex DMutex;
+        std::condition_variable DCondition;
+        std::thread DWorker;
+
+        SPartition(const std::vector< SDSVAggregate > &aggregates) : DTable(aggregates){
+
+        };
+    };
+
+    std::vector< std::size_t > DKeyColumns;
+    std::vector< SDSVAggregate > DAggregates;
+    std::vector< std::unique_ptr< SPartition > > DPartitions;
+    std::vector< std::size_t > DSlotOfColumn;   // source column to text slot
+    std::vector< std::size_t > DKeySlots;
+    std::vector< std::size_t > DValueSlots;     // NotSelected for Count
+    std::vector< std::string > DText;
+    std::uint64_t DRows;
+
+    SImplementation(std::vector< std::size_t > keycolumns, std::vector< SDSVAggregate > aggregates, std::size_t threads)
+        : DKeyColumns(std::move(keycolumns)), DAggregates(std::move(aggregates)), DRows(0){
+        for(std::size_t Index = 0; Index < std::max< std::size_t >(threads, 1); Index++){
+            DPartitions.push_back(std::make_unique< SPartition >(DAggregates));
+        }
+        for(auto Column : DKeyColumns){
+            DKeySlots.push_back(SlotOf(Column));
+        }
+        for(auto &Aggregate : DAggregates){
+            DValueSlots.push_back(Aggregate.DFunction == EDSVAggregateFunction::Count ? NotSelected : SlotOf(Aggregate.DColumn));
+        }
+    };
+
+    // Text slot a column is extracted into, shared by every use of the column
+    std::size_t SlotOf(std::size_t column){
+        if(column >= DSlotOfColumn.size()){
+            DSlotOfColumn.resize(column + 1, NotSelected);
+        }
+        if(DSlotOfColumn[column] == NotSelected){
+            DSlotOfColumn[column] = DText.size();
+            DText.emplace_back();
+        }
+        return DSlotOfColumn[column];
+    };
+
+    bool Scan(CDSVBasicReader< SDSVRuntimeDialect > &reader){
+        std::size_t FieldCount;
+        return reader.ScanRow([this](std::size_t index) -> std::string *{
+            if(index == 0){
+                for(auto &Text : DText){
+                    Text.clear();
+                }
+            }
+            if(index < DSlotOfColumn.size() && DSlotOfColumn[index] != NotSelected){
+                return &DText[DSlotOfColumn[index]];
+            }
+            return nullptr;
+        }, FieldCount);
+    };
+
+    // Appends the key fields of the scanned row, each prefixed by its length
+    // so ("ab","c") and ("a","bc") differ
+    void EncodeKey(std::string &key) const{
+        for(auto Slot : DKeySlots){
+            std::uint32_t Length = DText[Slot].size();
+            char Prefix[sizeof(Length)];
+            std::memcpy(Prefix, &Length, sizeof(Length));
+            key.append(Prefix, sizeof(Prefix));
+            key.append(DText[Slot]);
+        }
+    };
+
+    void ParseValues(SValue *values) const{
+        for(std::size_t Index = 0; Index < DAggregates.size(); Index++){
+            values[Index] = SValue();
+            if(DValueSlots[Index] == NotSelected){
+                continue;
+            }
+            const std::string &Text = DText[DValueSlots[Index]];
+            const char *Last = Text.data() + Text.size();
+            std::from_chars_result Result;
+            if(DAggregates[Index].DType == EDSVAggregateType::Integer){
+                Result = std::from_chars(Text.data(), Last, values[Index].DInteger);
+            }
+            else{
+                Result = std::from_chars(Text.data(), Last, values[Index].DDouble);
+            }
+            values[Index].DValid = !Text.empty() && Result.ec == std::errc() && Result.ptr == Last;
+        }
+    };
+
+    void WorkerLoop(SPartition &partition){
+        std::unique_lock<std::mutex> Lock(partition.DMutex);
+        while(true){
+            partition.DCondition.wait(Lock, [&partition]{ return partition.DDone || !partition.DQueue.empty(); });
+            if(partition.DQueue.empty()){
+                return;
+            }
+            SBatch Batch = std::move(partition.DQueue.front());
+            partition.DQueue.pop_front();
+            Lock.unlock();
+            partition.DCondition.notify_all();
+            partition.DTable.Add(Batch);
+            Batch.Clear();
+            Lock.lock();
+            partition.DSpare.push_back(std::move(Batch));
+        }
+    };
+
+    // Hands the filling batch to the partition's worker, blocking while its
+    // queue is full
+    void Submit(SPartition &partition){
+        if(!partition.DFilling.Size()){
+            return;
+        }
+        std::unique_lock<std::mutex> Lock(partition.DMutex);
+        partition.DCondition.wait(Lock, [&partition]{ return partition.DQueue.size() < DMaxBatches; });
+        partition.DQueue.push_back(std::move(partition.DFilling));
+        partition.DFilling.Clear();
+        if(!partition.DSpare.empty()){
+            partition.DFilling = std::move(partition.DSpare.back());
+            partition.DSpare.pop_back();
+        }
+        Lock.unlock();
+        partition.DCondition.notify_all();
+    };
+
+    bool Consume(std::shared_ptr< CDataSource > src, char delimiter, bool header){
+        CDSVBasicReader< SDSVRuntimeDialect > Reader(std::move(src), SDSVRuntimeDialect(delimiter));
+        if(header && !Scan(Reader)){
+            return true;
+        }
+        bool Parallel = DPartitions.size() > 1;
+        if(Parallel){
+            for(auto &Partition : DPartitions){
+                SPartition *PartitionPtr = Partition.get();
+                Partition->DDone = false;
+                Partition->DWorker = std::thread([this, PartitionPtr]{ WorkerLoop(*PartitionPtr); });
+            }
+        }
+        std::string Key;
+        std::vector< SValue > Values(DAggregates.size());
+        while(Scan(Reader)){
+            if(!Parallel){
+                Key.clear();
+                EncodeKey(Key);
+                ParseValues(Values.data());
+                DPartitions[0]->DTable.Add(Key, HashKey(Key), DRows++, Values.data());
+                continue;
+            }
+            Key.clear();
+            EncodeKey(Key);
+            std::uint64_t Hash = HashKey(Key);
+            SPartition &Partition = *DPartitions[Hash % DPartitions.size()];
+            SBatch &Batch = Partition.DFilling;
+            Batch.DKeys.append(Key);
+            Batch.DKeyEnds.push_back(Batch.DKeys.size());
+            Batch.DHashes.push_back(Hash);
+            Batch.DSequences.push_back(DRows++);
+            Batch.DValues.resize(Batch.DValues.size() + DAggregates.size());
+            ParseValues(Batch.DValues.data() + Batch.DValues.size() - DAggregates.size());
+            if(Batch.Size() >= DBatchSize){
+                Submit(Partition);
+            }
+        }
+        if(Parallel){
+            for(auto &Partition : DPartitions){
+                Submit(*Partition);
+                {
+                    std::lock_guard<std::mutex> Lock(Partition->DMutex);
+                    Partition->DDone = true;
+                }
+                Partition->DCondition.notify_all();
+            }
+            for(auto &Partition : DPartitions){
+                Partition->DWorker.join();
+            }
+        }
+        for(auto &Partition : DPartitions){
+            if(Partition->DTable.DOverflow){
+                return false;
+            }
+        }
+        return true;
+    };
+
+    std::string Format(const SDSVAggregate &aggregate, const SAccumulator &accumulator) const{
+        if(aggregate.DFunction == EDSVAggregateFunction::Count){
+            return std::to_string(accumulator.DCount);
+        }
+        bool Integer = aggregate.DType == EDSVAggregateType::Integer;
+        if(accumulator.DOverflow){
+            return std::string();
+        }
+        if(aggregate.DFunction == EDSVAggregateFunction::Sum){
+            return Integer ? std::to_string(accumulator.DInteger) : FormatDouble(accumulator.DDouble);
+        }
+        if(!accumulator.DCount){
+            return std::string();
+        }
+        if(aggregate.DFunction == EDSVAggregateFunction::Mean){
+            return FormatDouble((Integer ? double(accumulator.DInteger) : accumulator.DDouble) / accumulator.DCount);
+        }
+        return Integer ? std::to_string(accumulator.DInteger) : FormatDouble(accumulator.DDouble);
+    };
+
+    bool Write(CDSVWriter &writer) const{
+        // groups of all partitions in the order they were first seen
+        std::vector< std::pair< std::uint64_t, std::pair< std::size_t, std::size_t > > > Order;
+        for(std::size_t Partition = 0; Partition < DPartitions.size(); Partition++){
+            const CGroupTable &Table = DPartitions[Partition]->DTable;
+            for(std::size_t Group = 0; Group < Table.Size(); Group++){
+                Order.push_back({Table.DSequences[Group], {Partition, Group}});
+            }
+        }
+        std::sort(Order.begin(), Order.end());
+        std::vector< std::string_view > Fields(DKeyColumns.size() + DAggregates.size());
+        std::vector< std::string > Results(DAggregates.size());
+        bool Success = true;
+        for(auto &Entry : Order){
+            const CGroupTable &Table = DPartitions[Entry.second.first]->DTable;
+            std::string_view Key = Table.Key(Entry.second.second);
+            for(std::size_t Index = 0; Index < DKeyColumns.size(); Index++){
+                std::uint32_t Length;
+                std::memcpy(&Length, Key.data(), sizeof(Length));
+                Fields[Index] = Key.substr(sizeof(Length), Length);
+                Key.remove_prefix(sizeof(Length) + Length);
+            }
+            const SAccumulator *Accumulators = Table.DAccumulators.data() + Entry.second.second * DAggregates.size();
+            for(std::size_t Index = 0; Index < DAggregates.size(); Index++){
+                Results[Index] = Format(DAggregates[Index], Accumulators[Index]);
+                Fields[DKeyColumns.size() + Index] = Results[Index];
+            }
+            Success = writer.WriteRow(Fields.data(), Fields.size()) && Success;
+        }
+        return Success;
+    };
+};
+
+CDSVAggregator::CDSVAggregator(std::vector< std::size_t > keycolumns, std::vector< SDSVAggregate > aggregates, std::size_t threads)
+    : DImplementation(std::make_unique<SImplementation>(std::move(keycolumns), std::move(aggregates), threads)){
+
+}
+
+CDSVAggregator::~CDSVAggregator(){
+
+}
+
+// Adds every row of src to the groups, may be called for several sources.
+// False once an integer Sum or Mean of some group has overflowed.
+bool CDSVAggregator::Consume(std::shared_ptr< CDataSource > src, char delimiter, bool header){
+    return DImplementation->Consume(std::move(src), delimiter, header);
+}
+
+std::size_t CDSVAggregator::GroupCount() const{
+    std::size_t Count = 0;
+    for(auto &Partition : DImplementation->DPartitions){
+        Count += Partition->DTable.Size();
+    }
+    return Count;
+}
+
+// Writes one row per group, key fields then aggregates
+bool CDSVAggregator::Write(CDSVWriter &writer) const{
+    return DImplementation->Write(writer);
+}
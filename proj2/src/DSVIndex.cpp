@@ -0,0 +1,133 @@
+#include "DSVIndex.h"
+#include "DSVReaderT.h"
+#include <charconv>
+#include <string>
+#include <string_view>
+
+namespace{
+    
+const std::string IndexMagic = "DSVINDEX1";
+
+// Whole of text as an unsigned decimal, signs and other characters rejected
+bool ParseCount(std::string_view text, std::size_t &value){
+    const char *Last = text.data() + text.size();
+    auto Result = std::from_chars(text.data(), Last, value);
+    return !text.empty() && Result.ec == std::errc() && Result.ptr == Last;
+}
+
+}
+
+CDSVIndex::CDSVIndex(std::size_t stride) : DStride(stride ? stride : 1), DRowCount(0){
+
+}
+
+std::size_t CDSVIndex::Stride() const noexcept{
+    return DStride;
+}
+
+std::size_t CDSVIndex::RowCount() const noexcept{
+    return DRowCount;
+}
+
+// Offset of the indexed row at or before row
+std::size_t CDSVIndex::Offset(std::size_t row) const noexcept{
+    std::size_t Entry = row / DStride;
+    if(DOffsets.empty()){
+        return 0;
+    }
+    return DOffsets[Entry < DOffsets.size() ? Entry : DOffsets.size() - 1];
+}
+
+// Scans src to its end recording where rows start. The delimiter and options
+// must be those the rows will be read with; values are skipped, not built.
+bool CDSVIndex::Build(CDataSource &src, char delimiter, const SDSVReadOptions &options){
+    // src is only borrowed for the scan
+    CDSVBasicReader< SDSVRuntimeDialect > Reader(std::shared_ptr< CDataSource >(&src, [](CDataSource *){}), SDSVRuntimeDialect(delimiter), options);
+    DOffsets.clear();
+    DRowCount = 0;
+    while(!Reader.End()){
+        // a row skipped under SkipRow is scanned over by the same call, and
+        // is skipped again by a reader opened at this offset
+        std::size_t Start = Reader.Offset();
+        std::size_t FieldCount;
+        if(!Reader.ScanRow([](std::size_t) -> std::string *{ return nullptr; }, FieldCount)){
+            continue;
+        }
+        if(DRowCount % DStride == 0){
+            DOffsets.push_back(Start);
+        }
+        DRowCount++;
+    }
+    return true;
+}
+
+// Writes the index as text, a header line followed by one offset per line
+bool CDSVIndex::Save(CDataSink &sink) const{
+    std::string Text = IndexMagic + " " + std::to_string(DStride) + " " + std::to_string(DRowCount) + "\n";
+    for(auto Offset : DOffsets){
+        Text += std::to_string(Offset);
+        Text += '\n';
+    }
+    return sink.Write(std::vector<char>(Text.begin(), Text.end()));
+}
+
+bool CDSVIndex::Load(CDataSource &src){
+    std::string Text;
+    std::vector<char> Buffer;
+    while(src.Read(Buffer, 65536)){
+        Text.append(Buffer.data(), Buffer.size());
+    }
+    std::vector< std::size_t > Values;
+    std::string_view View(Text);
+    std::size_t Start = View.find('\n');
+    if(Start == std::string_view::npos || View.compare(0, IndexMagic.length() + 1, IndexMagic + " ") != 0){
+        return false;
+    }
+    // header is the magic, the stride and the row count separated by spaces
+    std::string_view Header = View.substr(IndexMagic.length() + 1, Start - IndexMagic.length() - 1);
+    std::size_t Space = Header.find(' ');
+    std::size_t Stride, RowCount;
+    if(Space == std::string_view::npos || !ParseCount(Header.substr(0, Space), Stride) || !ParseCount(Header.substr(Space + 1), RowCount)){
+        return false;
+    }
+    for(std::size_t Line = Start + 1; Line < View.length();){
+        std::size_t LineEnd = View.find('\n', Line);
+        std::size_t Offset;
+        if(LineEnd == std::string_view::npos || !ParseCount(View.substr(Line, LineEnd - Line), Offset)){
+            return false;
+        }
+        Values.push_back(Offset);
+        Line = LineEnd + 1;
+    }
+    if(!Stride || Values.size() != RowCount / Stride + (RowCount % Stride != 0)){
+        return false;
+    }
+    DStride = Stride;
+    DRowCount = RowCount;
+    DOffsets.swap(Values);
+    return true;
+}
+
+// Returns a reader whose next row is row, seeking src to the closest indexed
+// row and skipping the remainder, or nullptr if src cannot seek or there is
+// no such row. delimiter and options must match those given to Build. Under
+// the Fail policy a dropped row right before row makes the first ReadRow
+// return false, as it does when reading from the start.
+std::unique_ptr< CDSVReader > CDSVIndex::OpenAt(std::shared_ptr< CDataSource > src, char delimiter, std::size_t row, const SDSVReadOptions &options) const{
+    std::size_t Start = Offset(row);
+    if(row >= DRowCount || !src->Seek(Start)){
+        return nullptr;
+    }
+    // only the start of the stream can hold a byte order mark
+    SDSVReadOptions Options = options;
+    Options.DSkipBOM = Options.DSkipBOM && !Start;
+    auto Reader = std::make_unique<CDSVReader>(src, delimiter, Options);
+    std::vector<std::string> Skipped;
+    // rows dropped under the Fail policy were not counted by Build
+    for(std::size_t Skip = row % DStride; Skip && !Reader->End();){
+        if(Reader->ReadRow(Skipped)){
+            Skip--;
+        }
+    }
+    return Reader;
+}
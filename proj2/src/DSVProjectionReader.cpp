@@ -0,0 +1,179 @@
+#include "DSVProjectionReader.h"
+#include "DSVReaderT.h"
+#include <charconv>
+#include <deque>
+
+namespace{
+
+constexpr std::size_t NotSelected = static_cast<std::size_t>(-1);
+
+bool ParseInteger(const std::string &text, std::int64_t &value){
+    const char *Last = text.data() + text.size();
+    auto Result = std::from_chars(text.data(), Last, value);
+    return !text.empty() && Result.ec == std::errc() && Result.ptr == Last;
+}
+
+bool ParseDouble(const std::string &text, double &value){
+    const char *Last = text.data() + text.size();
+    auto Result = std::from_chars(text.data(), Last, value);
+    return !text.empty() && Result.ec == std::errc() && Result.ptr == Last;
+}
+
+}
+
+struct CDSVProjectionReader::SImplementation{
+    CDSVBasicReader<SDSVRuntimeDialect> DReader;
+    std::vector< SDSVColumn > DColumns;
+    std::vector< std::size_t > DSlotOfColumn;   // source column to first projected slot
+    std::vector< std::size_t > DTextSlot;       // slot holding the text of each slot
+    std::vector< std::string > DText;           // raw text of each projected slot
+    std::deque< std::vector< std::string > > DSampled; // rows read while inferring
+    bool DValid;
+    
+    SImplementation(std::shared_ptr< CDataSource > src, char delimiter, std::vector< SDSVColumn > columns, bool header, std::size_t samplerows)
+        : DReader(std::move(src), SDSVRuntimeDialect(delimiter)), DColumns(std::move(columns)), DTextSlot(DColumns.size()), DText(DColumns.size()), DValid(true){
+        if(header){
+            std::vector< std::string > Names;
+            DReader.ReadRow(Names);
+            for(auto &Column : DColumns){
+                if(!Column.DName.empty()){
+                    Column.DIndex = NotSelected;
+                    for(std::size_t Index = 0; Index < Names.size(); Index++){
+                        if(Names[Index] == Column.DName){
+                            Column.DIndex = Index;
+                            break;
+                        }
+                    }
+                    DValid = DValid && Column.DIndex != NotSelected;
+                }
+            }
+        }
+        for(std::size_t Slot = 0; Slot < DColumns.size(); Slot++){
+            std::size_t Index = DColumns[Slot].DIndex;
+            DTextSlot[Slot] = Slot;
+            if(Index == NotSelected){
+                continue;
+            }
+            if(Index >= DSlotOfColumn.size()){
+                DSlotOfColumn.resize(Index + 1, NotSelected);
+            }
+            // a column projected more than once is scanned into its first
+            // slot and the later slots read that text
+            if(DSlotOfColumn[Index] == NotSelected){
+                DSlotOfColumn[Index] = Slot;
+            }
+            DTextSlot[Slot] = DSlotOfColumn[Index];
+        }
+        Infer(samplerows);
+    }
+    
+    // Types every Infer column by the narrowest type all sampled values fit
+    void Infer(std::size_t samplerows){
+        std::vector< bool > Pending(DColumns.size());
+        std::vector< bool > AllInteger(DColumns.size(), true);
+        std::vector< bool > AllDouble(DColumns.size(), true);
+        bool Needed = false;
+        for(std::size_t Slot = 0; Slot < DColumns.size(); Slot++){
+            Pending[Slot] = DColumns[Slot].DType == EDSVColumnType::Infer;
+            Needed = Needed || Pending[Slot];
+        }
+        while(Needed && DSampled.size() < samplerows && ScanProjected()){
+            for(std::size_t Slot = 0; Slot < DColumns.size(); Slot++){
+                std::int64_t Integer;
+                double Double;
+                const std::string &Text = DText[DTextSlot[Slot]];
+                if(!Pending[Slot] || Text.empty()){
+                    continue;
+                }
+                AllInteger[Slot] = AllInteger[Slot] && ParseInteger(Text, Integer);
+                AllDouble[Slot] = AllDouble[Slot] && ParseDouble(Text, Double);
+            }
+            DSampled.push_back(DText);
+        }
+        for(std::size_t Slot = 0; Slot < DColumns.size(); Slot++){
+            if(Pending[Slot]){
+                DColumns[Slot].DType = AllInteger[Slot] ? EDSVColumnType::Integer : AllDouble[Slot] ? EDSVColumnType::Double : EDSVColumnType::String;
+            }
+        }
+    }
+    
+    // Reads the next row leaving the projected values in DText
+    bool ScanProjected(){
+        std::size_t FieldCount;
+        return DReader.ScanRow([this](std::size_t index) -> std::string *{
+            if(index == 0){
+                // start of a row, including one retried after a skipped bad row
+                for(auto &Text : DText){
+                    Text.clear();
+                }
+            }
+            if(index < DSlotOfColumn.size() && DSlotOfColumn[index] != NotSelected){
+                return &DText[DSlotOfColumn[index]];
+            }
+            return nullptr;
+        }, FieldCount);
+    }
+    
+    void Convert(const std::string &text, const SDSVColumn &column, SDSVValue &value){
+        value.DType = column.DType;
+        value.DString.clear();
+        switch(column.DType){
+            case EDSVColumnType::Integer:
+                value.DValid = ParseInteger(text, value.DInteger);
+                break;
+            case EDSVColumnType::Double:
+                value.DValid = ParseDouble(text, value.DDouble);
+                break;
+            default:
+                value.DValid = !text.empty();
+                value.DString.assign(text);
+                break;
+        }
+    }
+    
+    bool End() const{
+        return DSampled.empty() && DReader.End();
+    }
+    
+    bool ReadRow(std::vector< SDSVValue > &values){
+        if(!DSampled.empty()){
+            DText.swap(DSampled.front());
+            DSampled.pop_front();
+        }
+        else if(!ScanProjected()){
+            return false;
+        }
+        values.resize(DColumns.size());
+        for(std::size_t Slot = 0; Slot < DColumns.size(); Slot++){
+            Convert(DText[DTextSlot[Slot]], DColumns[Slot], values[Slot]);
+        }
+        return true;
+    }
+};
+
+CDSVProjectionReader::CDSVProjectionReader(std::shared_ptr< CDataSource > src, char delimiter, std::vector< SDSVColumn > columns, bool header, std::size_t samplerows)
+    : DImplementation(std::make_unique<SImplementation>(std::move(src), delimiter, std::move(columns), header, samplerows)){
+
+}
+
+CDSVProjectionReader::~CDSVProjectionReader(){
+
+}
+
+// False if a column named in the constructor is not in the header
+bool CDSVProjectionReader::Valid() const{
+    return DImplementation->DValid;
+}
+
+// Projected columns with their resolved index and type
+const std::vector< SDSVColumn > &CDSVProjectionReader::Columns() const{
+    return DImplementation->DColumns;
+}
+
+bool CDSVProjectionReader::End() const{
+    return DImplementation->End();
+}
+
+bool CDSVProjectionReader::ReadRow(std::vector< SDSVValue > &values){
+    return DImplementation->ReadRow(values);
+}
@@ -0,0 +1,197 @@
+#include "DSVPushParser.h"
+#include "DSVScanner.h"
+#include <deque>
+
+namespace{
+
+constexpr char ByteOrderMark[] = "\xEF\xBB\xBF";
+constexpr std::size_t ByteOrderMarkSize = 3;
+
+}
+
+// Bytes are handed to the same CDSVBasicScanner the pull reader uses, which
+// keeps a half scanned row between chunks. Complete rows are queued here.
+struct CDSVPushParser::SImplementation{
+    CDSVBasicScanner< SDSVRuntimeDialect > DScanner;
+    SDSVReadOptions DOptions;
+    std::deque< std::vector< std::string > > DReady;    // complete rows not yet read
+    std::vector< std::vector< std::string > > DSpare;   // rows handed back for reuse
+    std::vector< std::string > DRow;                    // row being scanned
+    std::string *DValue;        // value of DRow the scan appends to
+    std::string DPrefix;        // first bytes held back while looking for a BOM
+    std::function<void()> DReadyCallback;   // waiting consumer, called once
+    std::size_t DOffset;        // stream offset of the next byte fed
+    bool DStarted;              // BOM check done
+    bool DFailed;               // a row was dropped under the Fail policy
+    bool DFinished;
+
+    SImplementation(char delimiter, const SDSVReadOptions &options)
+        : DScanner(SDSVRuntimeDialect(delimiter), options), DOptions(options), DValue(nullptr), DOffset(0), DStarted(false), DFailed(false), DFinished(false){
+
+    };
+
+    // Slot for value index of the row being scanned, cleared for reuse
+    std::string *StartValue(std::size_t index){
+        if(index < DRow.size()){
+            DRow[index].clear();
+        }
+        else{
+            DRow.emplace_back();
+        }
+        return &DRow[index];
+    };
+
+    void EndRow(){
+        if(DScanner.SkipRow()){
+            return;
+        }
+        if(DScanner.FailRow()){
+            DFailed = true;
+            return;
+        }
+        DRow.resize(DScanner.FieldCount());
+        DReady.push_back(std::move(DRow));
+        if(DSpare.empty()){
+            DRow.clear();
+        }
+        else{
+            DRow = std::move(DSpare.back());
+            DSpare.pop_back();
+        }
+    };
+
+    void Scan(const char *data, std::size_t size){
+        while(size){
+            bool RowEnd;
+            std::size_t Used = DScanner.Scan(data, size, DOffset, [this](std::size_t index){ return StartValue(index); }, DValue, RowEnd);
+            data += Used;
+            size -= Used;
+            DOffset += Used;
+            if(RowEnd){
+                EndRow();
+            }
+        }
+    };
+
+    bool Feed(const char *data, std::size_t size){
+        DFailed = false;
+        // hold back the first bytes until it is known whether they are a BOM
+        if(!DStarted && DOptions.DSkipBOM){
+            while(size && DPrefix.size() < ByteOrderMarkSize && (DPrefix.empty() || DPrefix.back() == ByteOrderMark[DPrefix.size() - 1])){
+                DPrefix.push_back(*data++);
+                size--;
+            }
+            bool Matching = DPrefix.back() == ByteOrderMark[DPrefix.size() - 1];
+            if(Matching && DPrefix.size() < ByteOrderMarkSize){
+                return true;
+            }
+            ResolvePrefix();
+        }
+        DStarted = true;
+        Scan(data, size);
+        return !DFailed;
+    };
+
+    // Calls the waiting consumer once rows are ready or the input has ended,
+    // after the parser state is complete so the callback may read rows
+    void Notify(){
+        if(DReadyCallback && (!DReady.empty() || DFinished)){
+            std::function<void()> Callback;
+            Callback.swap(DReadyCallback);
+            Callback();
+        }
+    };
+
+    // Drops the held back bytes if they are a BOM, otherwise scans them
+    void ResolvePrefix(){
+        DStarted = true;
+        if(DPrefix == std::string_view(ByteOrderMark, ByteOrderMarkSize)){
+            DOffset += ByteOrderMarkSize;
+        }
+        else{
+            Scan(DPrefix.data(), DPrefix.size());
+        }
+        DPrefix.clear();
+    };
+
+    bool Finish(){
+        DFailed = false;
+        if(DFinished){
+            return true;
+        }
+        if(!DStarted){
+            ResolvePrefix();
+        }
+        DFinished = true;
+        if(DScanner.Finish(DValue, DOffset)){
+            EndRow();
+        }
+        return !DFailed;
+    };
+};
+
+CDSVPushParser::CDSVPushParser(char delimiter, const SDSVReadOptions &options) : DImplementation(std::make_unique<SImplementation>(delimiter, options)){
+
+}
+
+CDSVPushParser::~CDSVPushParser(){
+
+}
+
+// Scans the chunk, any rows it completes become available to ReadRow. Returns
+// false if the Fail policy dropped a row in this chunk.
+bool CDSVPushParser::Feed(const char *data, std::size_t size){
+    if(DImplementation->DFinished || !size){
+        return !DImplementation->DFinished;
+    }
+    bool Success = DImplementation->Feed(data, size);
+    DImplementation->Notify();
+    return Success;
+}
+
+bool CDSVPushParser::Feed(std::string_view data){
+    return Feed(data.data(), data.size());
+}
+
+// Ends the input, a last row without a trailing newline is completed
+bool CDSVPushParser::Finish(){
+    bool Success = DImplementation->Finish();
+    DImplementation->Notify();
+    return Success;
+}
+
+// Calls callback once, from the next Feed or Finish that leaves a row ready or
+// ends the input; it is not called for rows that are already ready. A later
+// callback replaces an earlier one and an empty one cancels the wait.
+void CDSVPushParser::OnReady(std::function<void()> callback){
+    DImplementation->DReadyCallback = std::move(callback);
+}
+
+std::size_t CDSVPushParser::RowsReady() const{
+    return DImplementation->DReady.size();
+}
+
+// Takes the oldest complete row, the strings previously held by row are kept
+// for rows scanned later so their capacity is reused
+bool CDSVPushParser::ReadRow(std::vector<std::string> &row){
+    if(DImplementation->DReady.empty()){
+        return false;
+    }
+    row.swap(DImplementation->DReady.front());
+    DImplementation->DSpare.push_back(std::move(DImplementation->DReady.front()));
+    DImplementation->DReady.pop_front();
+    return true;
+}
+
+// True once Finish was called and every row has been read
+bool CDSVPushParser::End() const{
+    return DImplementation->DFinished && DImplementation->DReady.empty();
+}
+
+const std::vector<SDSVError> &CDSVPushParser::Errors() const{
+    return DImplementation->DScanner.Errors();
+}
+
+void CDSVPushParser::ClearErrors(){
+    DImplementation->DScanner.ClearErrors();
+}
@@ -1,70 +1,51 @@
 #include "DSVReader.h"
+#include "DSVReaderT.h"
 #include "DataSource.h"
 #include <vector>
 #include <string>
-#include <sstream>
 
 
+// The runtime configurable reader wraps the templated reader with a dialect
+// whose delimiter is chosen at construction
 struct CDSVReader::SImplementation {
-    std::shared_ptr<CDataSource> source; // Data source to read from 
-    char delimiter; // Delimiter character
+    CDSVBasicReader<SDSVRuntimeDialect> reader; // Reader doing the scanning
     // constructor 
-    SImplementation(std::shared_ptr<CDataSource> src, char del){
-        source = src;
-        delimiter = del;
-    }
+    SImplementation(std::shared_ptr<CDataSource> src, char del, const SDSVReadOptions &options)
+        : reader(std::move(src), SDSVRuntimeDialect(del), options) {}
 
 };
 
 CDSVReader::CDSVReader(std::shared_ptr<CDataSource> src, char del) {
-    implementation = std::make_unique<SImplementation>(src, del);
+    implementation = std::make_unique<SImplementation>(src, del, SDSVReadOptions());
+}
+
+// Constructor with CRLF, BOM and malformed row handling options
+CDSVReader::CDSVReader(std::shared_ptr<CDataSource> src, char del, const SDSVReadOptions &options) {
+    implementation = std::make_unique<SImplementation>(src, del, options);
 }
 
 CDSVReader::~CDSVReader() {}
 
 bool CDSVReader::End() const {
-    // Implementation for End()
-    return implementation->source->End();;
+    return implementation->reader.End();
 }
 
+// Reads the next row into row, the strings already held by row are reused so
+// their capacity carries over from one call to the next
 bool CDSVReader::ReadRow(std::vector<std::string>& row) {
-    if (End()){
-        return false;   // end of DSV file
-    }
-    char ch;
-    std::string value; // string of a single value within DSV file
-    bool inQuotes = false; // track quoted values
-    row.clear();    // clear vector for new row
+    return implementation->reader.ReadRow(row);
+}
 
-    while (!implementation->source->End()) {
-        implementation->source->Get(ch); // read next character
-        if (ch == '\n' && !inQuotes) {   // end oof row and not within quotes
-            break;
-        }
-        if (ch == implementation->delimiter && !inQuotes) {  //delimeter reached & not within quotes
-            row.push_back(value);   //add value to row vector
-            value.clear();  // clear value for next one
-        } 
-        else if(ch == '"') { // quotation mark found
-            if (inQuotes) { 
-                char next;
-                if (implementation->source->Peek(next) && next == '"') {
-                    value += '"'; // qoute is apart of value
-                    implementation->source->Get(ch);  // skip quote
-                } 
-                else {
-                    inQuotes = false; // not within qoutes
-                }
-            } else {
-                inQuotes = true; // going into quotes
-            }
-        } else {
-            value += ch;    // add current char to value 
-        }
-    }
-    if (!value.empty()) {
-        row.push_back(value); // add last value wihout newline to the row
-    }
+// Read a row whose strings come from the row's memory resource
+bool CDSVReader::ReadRow(std::pmr::vector<std::pmr::string>& row) {
+    return implementation->reader.ReadRow(row);
+}
 
-    return true; // Row was successfully read
-}
\ No newline at end of file
+// Malformed rows seen so far, only recorded when the error policy is not lenient
+const std::vector<SDSVError> &CDSVReader::Errors() const {
+    return implementation->reader.Errors();
+}
+
+void CDSVReader::ClearErrors() {
+    implementation->reader.ClearErrors();
+}
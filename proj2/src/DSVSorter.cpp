@@ -0,0 +1,356 @@
+#include "DSVSorter.h"
+#include "DSVReader.h"
+#include "DSVWriter.h"
+#include "BinarySpill.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <queue>
+#include <string>
+#include <thread>
+
+namespace{
+
+constexpr std::size_t MaxFanIn = 64;                // runs merged at once, bounds open files
+constexpr std::size_t MergeReaderBytes = 2 * 65536; // block and buffer of one CBinarySpillReader
+
+using TFile = std::shared_ptr< std::FILE >;
+
+// Anonymous temporary file, removed by the system once closed
+TFile TemporaryFile(){
+    std::FILE *File = std::tmpfile();
+    return File ? TFile(File, std::fclose) : TFile();
+}
+
+class CFileSink : public CDataSink{
+    private:
+        TFile DFile;
+
+    public:
+        CFileSink(TFile file) : DFile(std::move(file)){
+
+        };
+
+        bool Put(const char &ch) noexcept override{
+            return std::fputc(ch, DFile.get()) != EOF;
+        };
+
+        bool Write(const std::vector<char> &buf) noexcept override{
+            return std::fwrite(buf.data(), 1, buf.size(), DFile.get()) == buf.size();
+        };
+
+        bool Flush() noexcept override{
+            return std::fflush(DFile.get()) == 0;
+        };
+};
+
+class CFileSource : public CDataSource{
+    private:
+        TFile DFile;
+
+    public:
+        CFileSource(TFile file) : DFile(std::move(file)){
+            std::rewind(DFile.get());
+        };
+
+        bool End() const noexcept override{
+            int Ch = std::fgetc(DFile.get());
+            if(Ch == EOF){
+                return true;
+            }
+            std::ungetc(Ch, DFile.get());
+            return false;
+        };
+
+        bool Get(char &ch) noexcept override{
+            int Ch = std::fgetc(DFile.get());
+            ch = static_cast<char>(Ch);
+            return Ch != EOF;
+        };
+
+        bool Peek(char &ch) noexcept override{
+            int Ch = std::fgetc(DFile.get());
+            if(Ch == EOF){
+                return false;
+            }
+            std::ungetc(Ch, DFile.get());
+            ch = static_cast<char>(Ch);
+            return true;
+        };
+
+        bool Read(std::vector<char> &buf, std::size_t count) noexcept override{
+            buf.resize(count);
+            buf.resize(std::fread(buf.data(), 1, count, DFile.get()));
+            return !buf.empty();
+        };
+};
+
+// Typed value of one key column, parsed once per row
+struct SKeyValue{
+    bool DValid = false;
+    std::int64_t DInteger = 0;
+    double DDouble = 0.0;
+};
+
+struct SRecord{
+    std::vector< std::string > DRow;
+    std::vector< SKeyValue > DKeys;
+};
+
+}
+
+struct CDSVSorter::SImplementation{
+    std::vector< SDSVSortKey > DKeys;
+    std::size_t DRunBytes;
+    std::size_t DThreads;
+    std::size_t DFanIn;
+    std::size_t DRunCount;
+
+    SImplementation(std::vector< SDSVSortKey > keys, std::size_t memorybudget, std::size_t threads)
+        : DKeys(std::move(keys)), DRunCount(0){
+        DThreads = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+        // half the budget goes to the readers of a merge, which sets how many
+        // runs are merged at once, the other half to the run being filled
+        // and one per worker
+        DFanIn = std::clamp< std::size_t >(memorybudget / 2 / MergeReaderBytes, 2, MaxFanIn);
+        DRunBytes = std::max< std::size_t >(memorybudget / 2 / (DThreads + 1), 1);
+    };
+
+    static const std::string &Field(const std::vector< std::string > &row, std::size_t column){
+        static const std::string Empty;
+        return column < row.size() ? row[column] : Empty;
+    };
+
+    void ParseKeys(SRecord &record) const{
+        record.DKeys.resize(DKeys.size());
+        for(std::size_t Index = 0; Index < DKeys.size(); Index++){
+            const std::string &Text = Field(record.DRow, DKeys[Index].DColumn);
+            const char *Last = Text.data() + Text.size();
+            SKeyValue &Value = record.DKeys[Index];
+            if(DKeys[Index].DType == EDSVSortType::Integer){
+                auto Result = std::from_chars(Text.data(), Last, Value.DInteger);
+                Value.DValid = !Text.empty() && Result.ec == std::errc() && Result.ptr == Last;
+            }
+            else if(DKeys[Index].DType == EDSVSortType::Double){
+                // NaN compares unordered with everything, it is treated as
+                // text like any other value that is not a number
+                auto Result = std::from_chars(Text.data(), Last, Value.DDouble);
+                Value.DValid = !Text.empty() && Result.ec == std::errc() && Result.ptr == Last && !std::isnan(Value.DDouble);
+            }
+        }
+    };
+
+    // Negative, zero or positive as left sorts before, with or after right
+    int Compare(const SRecord &left, const SRecord &right) const{
+        for(std::size_t Index = 0; Index < DKeys.size(); Index++){
+            const SDSVSortKey &Key = DKeys[Index];
+            const SKeyValue &LeftValue = left.DKeys[Index];
+            const SKeyValue &RightValue = right.DKeys[Index];
+            int Result = 0;
+            if(Key.DType != EDSVSortType::String && (LeftValue.DValid || RightValue.DValid)){
+                if(LeftValue.DValid != RightValue.DValid){
+                    Result = LeftValue.DValid ? 1 : -1;
+                }
+                else if(Key.DType == EDSVSortType::Integer){
+                    Result = (LeftValue.DInteger > RightValue.DInteger) - (LeftValue.DInteger < RightValue.DInteger);
+                }
+                else{
+                    Result = (LeftValue.DDouble > RightValue.DDouble) - (LeftValue.DDouble < RightValue.DDouble);
+                }
+            }
+            else{
+                Result = Field(left.DRow, Key.DColumn).compare(Field(right.DRow, Key.DColumn));
+            }
+            if(Result){
+                return Key.DDescending ? -Result : Result;
+            }
+        }
+        return 0;
+    };
+
+    static std::size_t RecordBytes(const SRecord &record){
+        std::size_t Bytes = sizeof(SRecord) + record.DKeys.size() * sizeof(SKeyValue);
+        for(auto &Value : record.DRow){
+            Bytes += sizeof(std::string) + Value.capacity();
+        }
+        return Bytes;
+    };
+
+    void SortRun(std::vector< SRecord > &run) const{
+        std::stable_sort(run.begin(), run.end(), [this](const SRecord &left, const SRecord &right){ return Compare(left, right) < 0; });
+    };
+
+    // Sorts a run and spills it, an empty pointer if the file failed
+    TFile SpillRun(std::vector< SRecord > run) const{
+        SortRun(run);
+        TFile File = TemporaryFile();
+        if(!File){
+            return File;
+        }
+        auto Sink = std::make_shared< CFileSink >(File);
+        CBinarySpillWriter Writer(Sink, false);
+        bool Success = true;
+        for(auto &Record : run){
+            Success = Writer.WriteRow(Record.DRow) && Success;
+        }
+        return Success && Writer.Flush() ? File : TFile();
+    };
+
+    // Merges the runs in files passing each row to output, ties go to the
+    // earlier run so the merge stays stable
+    template <typename TOutput>
+    bool Merge(const std::vector< TFile > &files, TOutput &&output) const{
+        struct SRun{
+            std::unique_ptr< CBinarySpillReader > DReader;
+            SRecord DRecord;
+        };
+        std::vector< SRun > Runs(files.size());
+        auto After = [this, &Runs](std::size_t left, std::size_t right){
+            int Result = Compare(Runs[left].DRecord, Runs[right].DRecord);
+            return Result ? Result > 0 : left > right;
+        };
+        std::priority_queue< std::size_t, std::vector< std::size_t >, decltype(After) > Heap(After);
+        for(std::size_t Index = 0; Index < files.size(); Index++){
+            Runs[Index].DReader = std::make_unique< CBinarySpillReader >(std::make_shared< CFileSource >(files[Index]));
+            if(Runs[Index].DReader->ReadRow(Runs[Index].DRecord.DRow)){
+                ParseKeys(Runs[Index].DRecord);
+                Heap.push(Index);
+            }
+        }
+        bool Success = true;
+        while(!Heap.empty()){
+            std::size_t Index = Heap.top();
+            Heap.pop();
+            Success = output(Runs[Index].DRecord.DRow) && Success;
+            if(Runs[Index].DReader->ReadRow(Runs[Index].DRecord.DRow)){
+                ParseKeys(Runs[Index].DRecord);
+                Heap.push(Index);
+            }
+        }
+        for(auto &Run : Runs){
+            Success = Success && Run.DReader->Next() == ESpillRecord::End;
+        }
+        return Success;
+    };
+
+    // Merges runs into a new run, the inputs are closed once it is written
+    TFile MergeRuns(std::vector< TFile > files) const{
+        TFile File = TemporaryFile();
+        if(!File){
+            return File;
+        }
+        auto Sink = std::make_shared< CFileSink >(File);
+        CBinarySpillWriter Writer(Sink, false);
+        bool Success = Merge(files, [&Writer](const std::vector< std::string > &row){ return Writer.WriteRow(row); });
+        files.clear();
+        return Success && Writer.Flush() ? File : TFile();
+    };
+
+    bool Sort(std::shared_ptr< CDataSource > src, std::shared_ptr< CDataSink > sink, char delimiter, bool header){
+        CDSVReader Reader(std::move(src), delimiter);
+        CDSVWriter Writer(sink, delimiter);
+        bool Success = true;
+        DRunCount = 0;
+        SRecord Record;
+        if(header && Reader.ReadRow(Record.DRow)){
+            Success = Writer.WriteRow(Record.DRow);
+        }
+
+        std::vector< SRecord > Run;
+        std::size_t RunBytes = 0;
+        std::deque< std::future< TFile > > Pending;
+        // Levels[0] holds spilled runs, a level reaching the fan-in is merged
+        // into one run of the next, so few files are open at any time and
+        // higher levels hold earlier input
+        std::vector< std::vector< TFile > > Levels;
+        auto Collect = [&](){
+            TFile File = Pending.front().get();
+            Pending.pop_front();
+            Success = Success && File;
+            for(std::size_t Level = 0; File; Level++){
+                if(Level == Levels.size()){
+                    Levels.emplace_back();
+                }
+                Levels[Level].push_back(std::move(File));
+                if(Levels[Level].size() < DFanIn){
+                    break;
+                }
+                File = MergeRuns(std::move(Levels[Level]));
+                Levels[Level].clear();
+                Success = Success && File;
+            }
+        };
+        while(Reader.ReadRow(Record.DRow)){
+            ParseKeys(Record);
+            RunBytes += RecordBytes(Record);
+            Run.push_back(std::move(Record));
+            Record = SRecord();
+            if(RunBytes >= DRunBytes){
+                if(Pending.size() == DThreads){
+                    Collect();
+                }
+                Pending.push_back(std::async(std::launch::async, &SImplementation::SpillRun, this, std::move(Run)));
+                Run.clear();
+                RunBytes = 0;
+                DRunCount++;
+            }
+        }
+
+        if(Pending.empty()){
+            // everything fit in one run, no need for temporary files
+            SortRun(Run);
+            DRunCount = Run.empty() ? 0 : 1;
+            for(auto &Sorted : Run){
+                Success = Writer.WriteRow(Sorted.DRow) && Success;
+            }
+            return sink->Flush() && Success;
+        }
+        if(!Run.empty()){
+            Pending.push_back(std::async(std::launch::async, &SImplementation::SpillRun, this, std::move(Run)));
+            DRunCount++;
+        }
+        while(!Pending.empty()){
+            Collect();
+        }
+        std::vector< TFile > Files;
+        for(auto Level = Levels.rbegin(); Level != Levels.rend(); ++Level){
+            Files.insert(Files.end(), Level->begin(), Level->end());
+        }
+        Levels.clear();
+        // one more pass over groups in input order while too many are left
+        while(Success && Files.size() > DFanIn){
+            std::vector< TFile > Merged;
+            for(std::size_t First = 0; First < Files.size(); First += DFanIn){
+                std::size_t Last = std::min(First + DFanIn, Files.size());
+                Merged.push_back(MergeRuns(std::vector< TFile >(Files.begin() + First, Files.begin() + Last)));
+                std::fill(Files.begin() + First, Files.begin() + Last, TFile());
+                Success = Success && Merged.back();
+            }
+            Files.swap(Merged);
+        }
+        return Success && Merge(Files, [&Writer](const std::vector< std::string > &row){ return Writer.WriteRow(row); }) && sink->Flush();
+    };
+};
+
+CDSVSorter::CDSVSorter(std::vector< SDSVSortKey > keys, std::size_t memorybudget, std::size_t threads)
+    : DImplementation(std::make_unique<SImplementation>(std::move(keys), memorybudget, threads)){
+
+}
+
+CDSVSorter::~CDSVSorter(){
+
+}
+
+// Reads all of src and writes its rows to sink in key order
+bool CDSVSorter::Sort(std::shared_ptr< CDataSource > src, std::shared_ptr< CDataSink > sink, char delimiter, bool header){
+    return DImplementation->Sort(std::move(src), std::move(sink), delimiter, header);
+}
+
+// Runs the last Sort produced, 1 when it was sorted in memory
+std::size_t CDSVSorter::RunCount() const{
+    return DImplementation->DRunCount;
+}
@@ -0,0 +1,162 @@
+#include "EditDistanceIndex.h"
+#include "StringUtils.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace{
+
+// Same result as StringUtils::EditDistance on already case folded strings,
+// computed with two rows reused between calls of the same thread
+int Distance(const std::string &left, const std::string &right){
+    thread_local std::vector<int> Previous, Current;
+    Previous.resize(right.size() + 1);
+    Current.resize(right.size() + 1);
+    for(std::size_t Column = 0; Column <= right.size(); Column++){
+        Previous[Column] = Column;
+    }
+    for(std::size_t Row = 1; Row <= left.size(); Row++){
+        Current[0] = Row;
+        for(std::size_t Column = 1; Column <= right.size(); Column++){
+            int Cost = left[Row - 1] == right[Column - 1] ? 0 : 1;
+            Current[Column] = std::min(std::min(Previous[Column] + 1, Current[Column - 1] + 1), Previous[Column - 1] + Cost);
+        }
+        std::swap(Previous, Current);
+    }
+    return Previous[right.size()];
+}
+
+bool MatchOrder(const SEditDistanceMatch &left, const SEditDistanceMatch &right){
+    return left.DDistance != right.DDistance ? left.DDistance < right.DDistance : left.DIndex < right.DIndex;
+}
+
+}
+
+struct CEditDistanceIndex::SImplementation{
+    // A node is one distinct key, entries equal to it after case folding are
+    // kept together. Children are found by their distance to the node.
+    struct SNode{
+        std::string DKey;
+        std::vector< std::size_t > DEntries;
+        std::vector< std::pair< int, std::size_t > > DChildren;
+    };
+
+    bool DIgnoreCase;
+    std::vector< std::string > DEntries;
+    std::vector< SNode > DNodes;
+
+    SImplementation(bool ignorecase) : DIgnoreCase(ignorecase){
+
+    };
+
+    std::string Key(const std::string &str) const{
+        std::string Result = str;
+        if(DIgnoreCase){
+            StringUtils::LowerInPlace(Result);
+        }
+        return Result;
+    };
+
+    void Insert(std::string key, std::size_t entry){
+        if(DNodes.empty()){
+            DNodes.push_back(SNode{std::move(key), {entry}, {}});
+            return;
+        }
+        std::size_t Node = 0;
+        while(true){
+            int NodeDistance = Distance(key, DNodes[Node].DKey);
+            if(NodeDistance == 0){
+                DNodes[Node].DEntries.push_back(entry);
+                return;
+            }
+            auto &Children = DNodes[Node].DChildren;
+            auto Child = std::find_if(Children.begin(), Children.end(), [NodeDistance](const std::pair< int, std::size_t > &edge){ return edge.first == NodeDistance; });
+            if(Child == Children.end()){
+                Children.emplace_back(NodeDistance, DNodes.size());
+                DNodes.push_back(SNode{std::move(key), {entry}, {}});
+                return;
+            }
+            Node = Child->second;
+        }
+    };
+
+    void Find(const std::string &key, int maxdistance, std::vector< SEditDistanceMatch > &matches) const{
+        matches.clear();
+        if(DNodes.empty() || maxdistance < 0){
+            return;
+        }
+        std::vector< std::size_t > Pending{0};
+        while(!Pending.empty()){
+            const SNode &Node = DNodes[Pending.back()];
+            Pending.pop_back();
+            int NodeDistance = Distance(key, Node.DKey);
+            if(NodeDistance <= maxdistance){
+                for(auto Entry : Node.DEntries){
+                    matches.push_back(SEditDistanceMatch{Entry, NodeDistance});
+                }
+            }
+            // by the triangle inequality only children whose distance to
+            // the node is within maxdistance of NodeDistance can match
+            for(auto &Child : Node.DChildren){
+                if(Child.first >= NodeDistance - maxdistance && Child.first <= NodeDistance + maxdistance){
+                    Pending.push_back(Child.second);
+                }
+            }
+        }
+        std::sort(matches.begin(), matches.end(), MatchOrder);
+    };
+};
+
+CEditDistanceIndex::CEditDistanceIndex(bool ignorecase) : DImplementation(std::make_unique<SImplementation>(ignorecase)){
+
+}
+
+CEditDistanceIndex::~CEditDistanceIndex(){
+
+}
+
+// Adds an entry and returns its index
+std::size_t CEditDistanceIndex::Add(const std::string &entry){
+    std::size_t Index = DImplementation->DEntries.size();
+    DImplementation->DEntries.push_back(entry);
+    DImplementation->Insert(DImplementation->Key(entry), Index);
+    return Index;
+}
+
+std::size_t CEditDistanceIndex::Size() const{
+    return DImplementation->DEntries.size();
+}
+
+const std::string &CEditDistanceIndex::Entry(std::size_t index) const{
+    return DImplementation->DEntries[index];
+}
+
+// Entries within maxdistance of query, closest first then in the order added
+std::vector< SEditDistanceMatch > CEditDistanceIndex::Find(const std::string &query, int maxdistance) const{
+    std::vector< SEditDistanceMatch > Matches;
+    DImplementation->Find(DImplementation->Key(query), maxdistance, Matches);
+    return Matches;
+}
+
+// Find for each query, the queries are shared out to threads (0 uses the
+// hardware concurrency) and the results come back in query order
+std::vector< std::vector< SEditDistanceMatch > > CEditDistanceIndex::FindAll(const std::vector< std::string > &queries, int maxdistance, std::size_t threads) const{
+    std::vector< std::vector< SEditDistanceMatch > > Results(queries.size());
+    std::size_t ThreadCount = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+    ThreadCount = std::min(ThreadCount, queries.size());
+    std::atomic< std::size_t > NextQuery(0);
+    auto Worker = [&](){
+        for(std::size_t Query = NextQuery++; Query < queries.size(); Query = NextQuery++){
+            DImplementation->Find(DImplementation->Key(queries[Query]), maxdistance, Results[Query]);
+        }
+    };
+    std::vector< std::thread > Threads;
+    for(std::size_t Index = 1; Index < ThreadCount; Index++){
+        Threads.emplace_back(Worker);
+    }
+    Worker();
+    for(auto &Thread : Threads){
+        Thread.join();
+    }
+    return Results;
+}
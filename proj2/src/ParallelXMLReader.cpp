@@ -0,0 +1,361 @@
+#include "ParallelXMLReader.h"
+#include "XMLReader.h"
+#include "StringDataSource.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+
+namespace{
+
+// Entities of a batch of records, or of the root tags
+struct SBatchResult{
+    bool DSuccess = true;
+    std::vector< SXMLEntity > DEntities;
+};
+
+// Builds entities for everything inside the batch wrapper element
+class CBatchHandler : public CXMLHandler{
+    public:
+        std::vector< SXMLEntity > &DEntities;
+        std::size_t DDepth = 0;
+        
+        CBatchHandler(std::vector< SXMLEntity > &entities) : DEntities(entities){
+        
+        }
+        
+        void StartElement(const SXMLName &name, const std::vector< SXMLAttributeView > &attributes) override{
+            if(DDepth++){
+                DEntities.emplace_back();
+                SXMLEntity &Entity = DEntities.back();
+                Entity.DType = SXMLEntity::EType::StartElement;
+                Entity.DNameData = name.DLocal;
+                for(auto &Attribute : attributes){
+                    Entity.DAttributes.emplace_back(std::string(Attribute.DName.DLocal), std::string(Attribute.DValue));
+                }
+            }
+        }
+        
+        void EndElement(const SXMLName &name) override{
+            if(--DDepth){
+                DEntities.emplace_back();
+                DEntities.back().DType = SXMLEntity::EType::EndElement;
+                DEntities.back().DNameData = name.DLocal;
+            }
+        }
+        
+        void CharData(std::string_view data) override{
+            if(DDepth > 1){
+                DEntities.emplace_back();
+                DEntities.back().DType = SXMLEntity::EType::CharData;
+                DEntities.back().DNameData = data;
+            }
+        }
+};
+
+SBatchResult ParseBatch(const std::string &text){
+    SBatchResult Result;
+    CBatchHandler Handler(Result.DEntities);
+    CXMLReader Reader(std::make_shared<CStringDataSource>(text));
+    Result.DSuccess = Reader.Parse(Handler);
+    return Result;
+}
+
+const std::string BatchOpen = "<batch>";
+const std::string BatchClose = "</batch>";
+
+}
+
+struct CParallelXMLReader::SImplementation{
+    static constexpr std::size_t ChunkSize = 65536;
+    static constexpr std::size_t BatchSize = 65536;    // bytes of records per task
+    
+    enum class ETag{Start, End, Empty, Other};
+    
+    std::shared_ptr< CDataSource > DSource;
+    bool DSourceDone;
+    std::vector<char> DChunk;
+    std::string DPending;           // input not yet fully scanned
+    std::size_t DScanPos;
+    std::size_t DRecordStart;       // offset in DPending of the open record
+    std::size_t DDepth;
+    bool DRootClosed;
+    bool DError;
+    std::string DRootName;
+    std::string DBatch;             // records gathered for the next task
+    
+    std::deque< std::future<SBatchResult> > DResults;  // in document order
+    SBatchResult DCurrent;
+    std::size_t DCurrentIndex;
+    bool DEnd;
+    
+    std::size_t DThreadCount;
+    std::vector< std::thread > DThreads;
+    std::deque< std::packaged_task<SBatchResult()> > DTasks;
+    std::mutex DMutex;
+    std::condition_variable DCondition;
+    bool DStop;
+    
+    SImplementation(std::shared_ptr< CDataSource > src, std::size_t threads)
+        : DSource(std::move(src)), DSourceDone(false), DScanPos(0), DRecordStart(0), DDepth(0), DRootClosed(false), DError(false), 
+          DCurrentIndex(0), DEnd(false), DStop(false){
+        DThreadCount = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+        for(std::size_t Index = 0; Index < DThreadCount; Index++){
+            DThreads.emplace_back([this]{ WorkerLoop(); });
+        }
+        DBatch = BatchOpen;
+    }
+    
+    ~SImplementation(){
+        {
+            std::lock_guard<std::mutex> Lock(DMutex);
+            DStop = true;
+        }
+        DCondition.notify_all();
+        for(auto &Thread : DThreads){
+            Thread.join();
+        }
+    }
+    
+    void WorkerLoop(){
+        std::unique_lock<std::mutex> Lock(DMutex);
+        while(true){
+            DCondition.wait(Lock, [this]{ return DStop || !DTasks.empty(); });
+            if(DTasks.empty()){
+                return;
+            }
+            auto Task = std::move(DTasks.front());
+            DTasks.pop_front();
+            Lock.unlock();
+            Task();
+            Lock.lock();
+        }
+    }
+    
+    void PushReady(SBatchResult result){
+        std::promise<SBatchResult> Promise;
+        DResults.push_back(Promise.get_future());
+        Promise.set_value(std::move(result));
+    }
+    
+    void SubmitBatch(){
+        if(DBatch.size() == BatchOpen.size()){
+            return;
+        }
+        DBatch += BatchClose;
+        std::packaged_task<SBatchResult()> Task([Text = std::move(DBatch)]{ return ParseBatch(Text); });
+        DBatch = BatchOpen;
+        DResults.push_back(Task.get_future());
+        {
+            std::lock_guard<std::mutex> Lock(DMutex);
+            DTasks.push_back(std::move(Task));
+        }
+        DCondition.notify_one();
+    }
+    
+    // Classifies the markup starting with '<' at pos and finds its end, false
+    // if more input is needed to tell
+    bool ScanTag(std::size_t pos, std::size_t &end, ETag &kind){
+        auto FindClose = [this, &end](std::size_t from, const char *terminator) -> bool{
+            std::size_t Found = DPending.find(terminator, from);
+            if(Found == std::string::npos){
+                return false;
+            }
+            end = Found + std::char_traits<char>::length(terminator);
+            return true;
+        };
+        std::size_t Available = DPending.size() - pos;
+        if(Available < 9 && !DSourceDone){
+            return false;
+        }
+        kind = ETag::Other;
+        if(DPending.compare(pos, 4, "<!--") == 0){
+            return FindClose(pos + 4, "-->");
+        }
+        if(DPending.compare(pos, 9, "<![CDATA[") == 0){
+            return FindClose(pos + 9, "]]>");
+        }
+        if(DPending.compare(pos, 2, "<?") == 0){
+            return FindClose(pos + 2, "?>");
+        }
+        if(DPending.compare(pos, 2, "</") == 0){
+            kind = ETag::End;
+            return FindClose(pos + 2, ">");
+        }
+        // start tag or declaration, '>' inside quotes or a DTD subset does not end it
+        char Quote = 0;
+        int Brackets = 0;
+        bool Declaration = DPending.compare(pos, 2, "<!") == 0;
+        for(std::size_t Index = pos + 1; Index < DPending.size(); Index++){
+            char Ch = DPending[Index];
+            if(Quote){
+                Quote = Ch == Quote ? 0 : Quote;
+            }
+            else if(Ch == '"' || Ch == '\''){
+                Quote = Ch;
+            }
+            else if(Ch == '[' && Declaration){
+                Brackets++;
+            }
+            else if(Ch == ']' && Declaration){
+                Brackets--;
+            }
+            else if(Ch == '>' && Brackets <= 0){
+                end = Index + 1;
+                if(!Declaration){
+                    kind = DPending[Index - 1] == '/' ? ETag::Empty : ETag::Start;
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    // Parses the root start tag on its own, producing its start entity
+    void RootStart(std::size_t pos, std::size_t end, ETag kind){
+        std::string Text = BatchOpen + DPending.substr(pos, end - pos);
+        if(kind == ETag::Start){
+            std::size_t NameEnd = DPending.find_first_of(" \t\r\n/>", pos + 1);
+            DRootName = DPending.substr(pos + 1, NameEnd - pos - 1);
+            Text += "</" + DRootName + ">";
+        }
+        Text += BatchClose;
+        SBatchResult Result = ParseBatch(Text);
+        DError = DError || !Result.DSuccess || Result.DEntities.empty();
+        if(kind == ETag::Start && !Result.DEntities.empty()){
+            Result.DEntities.pop_back();
+        }
+        PushReady(std::move(Result));
+    }
+    
+    void RootEnd(){
+        SBatchResult Result;
+        Result.DEntities.emplace_back();
+        Result.DEntities.back().DType = SXMLEntity::EType::EndElement;
+        Result.DEntities.back().DNameData = DRootName;
+        PushReady(std::move(Result));
+    }
+    
+    // Scans input until the number of results waiting reaches limit, returns
+    // false once there is nothing more to scan
+    bool Advance(std::size_t limit){
+        std::size_t Initial = DResults.size();
+        while(!DError && !DRootClosed && DResults.size() < limit){
+            std::size_t Open = DPending.find('<', DScanPos);
+            std::size_t End;
+            ETag Kind;
+            if(Open == std::string::npos || !ScanTag(Open, End, Kind)){
+                if(DSourceDone){
+                    DError = true; // document ended inside the root
+                    break;
+                }
+                // drop what no longer needs to be kept, then read more
+                std::size_t Keep = DDepth > 1 ? DRecordStart : (Open == std::string::npos ? DPending.size() : Open);
+                DPending.erase(0, Keep);
+                DRecordStart -= DDepth > 1 ? Keep : 0;
+                DScanPos = Open == std::string::npos ? DPending.size() : Open - Keep;
+                if(DSource->Read(DChunk, ChunkSize)){
+                    DPending.append(DChunk.data(), DChunk.size());
+                }
+                else{
+                    DSourceDone = true;
+                }
+                continue;
+            }
+            DScanPos = End;
+            if(Kind == ETag::Other){
+                continue;
+            }
+            if(DDepth == 0){
+                if(Kind == ETag::End){
+                    DError = true;
+                    break;
+                }
+                RootStart(Open, End, Kind);
+                if(Kind == ETag::Empty){
+                    DRootClosed = true;
+                }
+                else{
+                    DDepth = 1;
+                }
+                continue;
+            }
+            if(Kind == ETag::Start){
+                if(DDepth++ == 1){
+                    DRecordStart = Open;
+                }
+            }
+            else if(Kind == ETag::Empty){
+                if(DDepth == 1){
+                    DRecordStart = Open;
+                }
+                else{
+                    continue;
+                }
+            }
+            else if(--DDepth == 0){
+                SubmitBatch();
+                RootEnd();
+                DRootClosed = true;
+                continue;
+            }
+            if(DDepth == 1){
+                // a record just completed
+                DBatch.append(DPending, DRecordStart, End - DRecordStart);
+                if(DBatch.size() >= BatchSize){
+                    SubmitBatch();
+                }
+            }
+        }
+        if(DError || DRootClosed){
+            SubmitBatch();
+        }
+        return DResults.size() > Initial;
+    }
+    
+    bool ReadEntity(SXMLEntity &entity, bool skipcdata){
+        while(!DEnd){
+            if(DCurrentIndex < DCurrent.DEntities.size()){
+                SXMLEntity &Next = DCurrent.DEntities[DCurrentIndex++];
+                if(skipcdata && Next.DType == SXMLEntity::EType::CharData){
+                    continue;
+                }
+                entity = std::move(Next);
+                return true;
+            }
+            // keep every worker busy before waiting on the oldest result
+            Advance(DThreadCount * 2);
+            if(DResults.empty()){
+                DEnd = true;
+                break;
+            }
+            DCurrent = DResults.front().get();
+            DResults.pop_front();
+            DCurrentIndex = 0;
+            if(!DCurrent.DSuccess){
+                DError = true;
+                DEnd = true;
+            }
+        }
+        return false;
+    }
+};
+
+CParallelXMLReader::CParallelXMLReader(std::shared_ptr< CDataSource > src, std::size_t threads)
+    : DImplementation(std::make_unique<SImplementation>(std::move(src), threads)){
+
+}
+
+CParallelXMLReader::~CParallelXMLReader(){
+
+}
+
+bool CParallelXMLReader::End() const{
+    return DImplementation->DEnd;
+}
+
+bool CParallelXMLReader::ReadEntity(SXMLEntity &entity, bool skipcdata){
+    return DImplementation->ReadEntity(entity, skipcdata);
+}
@@ -0,0 +1,124 @@
+#include "ReadAheadDataSource.h"
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+struct CReadAheadDataSource::SImplementation{
+    std::shared_ptr< CDataSource > DSource;
+    std::size_t DBufferSize;
+    std::vector< std::vector<char> > DBuffers;  // ring, DCount filled from DHead
+    std::size_t DHead;
+    std::size_t DCount;
+    std::size_t DOffset;    // consumer position in the head buffer
+    bool DHaveCurrent;      // consumer holds the head buffer
+    bool DSourceDone;
+    bool DStop;
+    std::mutex DMutex;
+    std::condition_variable DCondition;
+    std::thread DWorker;
+    
+    SImplementation(std::shared_ptr< CDataSource > src, std::size_t buffersize, std::size_t buffercount) 
+        : DSource(std::move(src)), DBufferSize(std::max<std::size_t>(buffersize, 1)), DBuffers(std::max<std::size_t>(buffercount, 2)), 
+          DHead(0), DCount(0), DOffset(0), DHaveCurrent(false), DSourceDone(false), DStop(false){
+        DWorker = std::thread([this]{ WorkerLoop(); });
+    }
+    
+    ~SImplementation(){
+        {
+            std::lock_guard<std::mutex> Lock(DMutex);
+            DStop = true;
+        }
+        DCondition.notify_all();
+        DWorker.join();
+    }
+    
+    // Fills free ring slots until the source is drained or the reader stops
+    void WorkerLoop(){
+        std::unique_lock<std::mutex> Lock(DMutex);
+        while(true){
+            DCondition.wait(Lock, [this]{ return DStop || DCount < DBuffers.size(); });
+            if(DStop){
+                return;
+            }
+            std::vector<char> &Slot = DBuffers[(DHead + DCount) % DBuffers.size()];
+            Lock.unlock();
+            bool Success = DSource->Read(Slot, DBufferSize);
+            Lock.lock();
+            if(!Success){
+                DSourceDone = true;
+                DCondition.notify_all();
+                return;
+            }
+            DCount++;
+            DCondition.notify_all();
+        }
+    }
+    
+    // Makes sure the head buffer has unread data, waiting on the worker if
+    // needed, false at the end of the source. Only the consumer moves DHead so
+    // the common case of data left in the head buffer needs no lock.
+    bool Fill(){
+        if(DHaveCurrent && DOffset < DBuffers[DHead].size()){
+            return true;
+        }
+        std::unique_lock<std::mutex> Lock(DMutex);
+        do{
+            if(DHaveCurrent){
+                DHead = (DHead + 1) % DBuffers.size();
+                DCount--;
+                DOffset = 0;
+                DCondition.notify_all();
+            }
+            DCondition.wait(Lock, [this]{ return DCount || DSourceDone; });
+            DHaveCurrent = DCount != 0;
+        }while(DHaveCurrent && DBuffers[DHead].empty());
+        return DHaveCurrent;
+    }
+    
+    // Head buffer access, only valid after Fill returned true
+    std::vector<char> &Current(){
+        return DBuffers[DHead];
+    }
+};
+
+CReadAheadDataSource::CReadAheadDataSource(std::shared_ptr< CDataSource > src, std::size_t buffersize, std::size_t buffercount) 
+    : DImplementation(std::make_unique<SImplementation>(std::move(src), buffersize, buffercount)){
+
+}
+
+CReadAheadDataSource::~CReadAheadDataSource(){
+
+}
+
+bool CReadAheadDataSource::End() const noexcept{
+    return !DImplementation->Fill();
+}
+
+bool CReadAheadDataSource::Get(char &ch) noexcept{
+    if(!DImplementation->Fill()){
+        return false;
+    }
+    ch = DImplementation->Current()[DImplementation->DOffset++];
+    return true;
+}
+
+bool CReadAheadDataSource::Peek(char &ch) noexcept{
+    if(!DImplementation->Fill()){
+        return false;
+    }
+    ch = DImplementation->Current()[DImplementation->DOffset];
+    return true;
+}
+
+bool CReadAheadDataSource::Read(std::vector<char> &buf, std::size_t count) noexcept{
+    buf.clear();
+    while(buf.size() < count && DImplementation->Fill()){
+        auto &Impl = *DImplementation;
+        auto &Current = Impl.Current();
+        std::size_t Length = std::min(count - buf.size(), Current.size() - Impl.DOffset);
+        buf.insert(buf.end(), Current.begin() + Impl.DOffset, Current.begin() + Impl.DOffset + Length);
+        Impl.DOffset += Length;
+    }
+    return !buf.empty();
+}
@@ -0,0 +1,69 @@
+#include "SegmentedDataSink.h"
+#include <algorithm>
+
+CSegmentedDataSink::CSegmentedDataSink(std::size_t segmentsize) : DSegmentSize(segmentsize ? segmentsize : 1), DSize(0), DSealed(false){
+
+}
+
+// Segment to append to, a new one is started when the last is full or has
+// been handed out
+std::vector<char> &CSegmentedDataSink::Current(){
+    if(DSegments.empty() || DSealed || DSegments.back()->size() == DSegmentSize){
+        DSegments.push_back(std::make_shared< std::vector<char> >());
+        DSegments.back()->reserve(DSegmentSize);
+        DSealed = false;
+    }
+    return *DSegments.back();
+}
+
+std::size_t CSegmentedDataSink::Size() const noexcept{
+    return DSize;
+}
+
+// Shares the segments written so far, they are not written again
+std::vector< CSharedBufferDataSource::TSegment > CSegmentedDataSink::Segments(){
+    DSealed = true;
+    return std::vector< CSharedBufferDataSource::TSegment >(DSegments.begin(), DSegments.end());
+}
+
+std::shared_ptr< CSharedBufferDataSource > CSegmentedDataSink::Source(){
+    return std::make_shared< CSharedBufferDataSource >(Segments());
+}
+
+// Copies the output into one string
+std::string CSegmentedDataSink::String() const{
+    std::string Result;
+    Result.reserve(DSize);
+    for(auto &Segment : DSegments){
+        Result.append(Segment->data(), Segment->size());
+    }
+    return Result;
+}
+
+bool CSegmentedDataSink::Put(const char &ch) noexcept{
+    try{
+        Current().push_back(ch);
+    }
+    catch(...){
+        return false;
+    }
+    DSize++;
+    return true;
+}
+
+bool CSegmentedDataSink::Write(const std::vector<char> &buf) noexcept{
+    try{
+        std::size_t Offset = 0;
+        while(Offset < buf.size()){
+            std::vector<char> &Segment = Current();
+            std::size_t Length = std::min(DSegmentSize - Segment.size(), buf.size() - Offset);
+            Segment.insert(Segment.end(), buf.begin() + Offset, buf.begin() + Offset + Length);
+            Offset += Length;
+            DSize += Length;
+        }
+    }
+    catch(...){
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,241 @@
+#include "ShardedDSVWriter.h"
+#include "DSVWriter.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace{
+
+// Collects the lines a shard's writer produces and hands them to the real
+// sink in large writes. Only the shard's worker uses it, or Flush once the
+// worker is idle.
+class CBufferedSink : public CDataSink{
+    private:
+        static constexpr std::size_t DBufferSize = 65536;
+        
+        std::shared_ptr< CDataSink > DSink;
+        std::vector<char> DBuffer;
+        
+    public:
+        CBufferedSink(std::shared_ptr< CDataSink > sink) : DSink(std::move(sink)){
+            DBuffer.reserve(DBufferSize);
+        }
+        
+        // Writes what is buffered, the buffer is dropped even if that fails
+        bool Spill(){
+            bool Success = DBuffer.empty() || DSink->Write(DBuffer);
+            DBuffer.clear();
+            return Success;
+        }
+        
+        bool Put(const char &ch) noexcept override{
+            DBuffer.push_back(ch);
+            return DBuffer.size() < DBufferSize || Spill();
+        }
+        
+        bool Write(const std::vector<char> &buf) noexcept override{
+            DBuffer.insert(DBuffer.end(), buf.begin(), buf.end());
+            return DBuffer.size() < DBufferSize || Spill();
+        }
+        
+        bool Flush() noexcept override{
+            bool Success = Spill();
+            return DSink->Flush() && Success;
+        }
+};
+
+}
+
+struct CShardedDSVWriter::SImplementation{
+    static constexpr std::size_t DBatchSize = 256;  // rows handed over at once
+    static constexpr std::size_t DMaxBatches = 8;   // queued batches per shard
+    
+    using TBatch = std::vector< std::vector<std::string> >;
+    
+    struct SShard{
+        std::shared_ptr< CBufferedSink > DSink;
+        CDSVWriter DWriter;
+        TBatch DFilling;                // batch the caller is adding rows to
+        std::size_t DFillCount = 0;     // rows used in DFilling
+        std::deque< std::pair<TBatch, std::size_t> > DQueue;
+        std::vector< TBatch > DSpare;   // written batches kept for reuse
+        bool DBusy = false;
+        std::atomic<bool> DError{false};  // set by the worker, cleared by Flush
+        std::atomic<std::size_t> DRows{0};
+        std::mutex DMutex;
+        std::condition_variable DCondition;
+        std::thread DWorker;
+        
+        SShard(std::shared_ptr< CDataSink > sink, char delimiter, bool quoteall) 
+            : DSink(std::make_shared<CBufferedSink>(std::move(sink))), DWriter(DSink, delimiter, quoteall){
+        
+        }
+    };
+    
+    std::vector< std::unique_ptr<SShard> > DShards;
+    std::vector< std::size_t > DKeyColumns;
+    std::atomic<bool> DStop;
+    
+    SImplementation(std::vector< std::shared_ptr< CDataSink > > sinks, const std::vector< std::size_t > &keycolumns, char delimiter, bool quoteall) 
+        : DKeyColumns(keycolumns), DStop(false){
+        for(auto &Sink : sinks){
+            DShards.push_back(std::make_unique<SShard>(Sink, delimiter, quoteall));
+        }
+        for(auto &Shard : DShards){
+            SShard *ShardPtr = Shard.get();
+            Shard->DWorker = std::thread([this, ShardPtr]{ WorkerLoop(*ShardPtr); });
+        }
+    }
+    
+    ~SImplementation(){
+        Flush();
+        for(auto &Shard : DShards){
+            {
+                std::lock_guard<std::mutex> Lock(Shard->DMutex);
+                DStop = true;
+            }
+            Shard->DCondition.notify_all();
+            Shard->DWorker.join();
+        }
+    }
+    
+    // FNV-1a over the key values, separated so ("ab","c") and ("a","bc") differ
+    std::size_t ShardOf(const std::vector<std::string> &row) const{
+        if(DShards.empty()){
+            return 0;
+        }
+        std::uint64_t Hash = 14695981039346656037ULL;
+        for(auto Column : DKeyColumns){
+            if(Column < row.size()){
+                for(unsigned char Ch : row[Column]){
+                    Hash = (Hash ^ Ch) * 1099511628211ULL;
+                }
+            }
+            Hash = (Hash ^ 0xFF) * 1099511628211ULL;
+        }
+        return Hash % DShards.size();
+    }
+    
+    void WorkerLoop(SShard &shard){
+        std::unique_lock<std::mutex> Lock(shard.DMutex);
+        while(true){
+            shard.DCondition.wait(Lock, [this, &shard]{ return DStop || !shard.DQueue.empty(); });
+            if(shard.DQueue.empty()){
+                return;
+            }
+            auto Entry = std::move(shard.DQueue.front());
+            shard.DQueue.pop_front();
+            shard.DBusy = true;
+            Lock.unlock();
+            shard.DCondition.notify_all();
+            bool Success = true;
+            for(std::size_t Index = 0; Index < Entry.second; Index++){
+                Success = shard.DWriter.WriteRow(Entry.first[Index]) && Success;
+            }
+            shard.DRows += Entry.second;
+            Lock.lock();
+            if(!Success){
+                shard.DError = true;
+            }
+            shard.DSpare.push_back(std::move(Entry.first));
+            shard.DBusy = false;
+            shard.DCondition.notify_all();
+        }
+    }
+    
+    // Hands the filling batch of shard to its worker, blocking while its queue is full
+    void Submit(SShard &shard){
+        if(!shard.DFillCount){
+            return;
+        }
+        std::unique_lock<std::mutex> Lock(shard.DMutex);
+        shard.DCondition.wait(Lock, [&shard]{ return shard.DQueue.size() < DMaxBatches; });
+        shard.DQueue.emplace_back(std::move(shard.DFilling), shard.DFillCount);
+        shard.DFilling.clear();
+        if(!shard.DSpare.empty()){
+            shard.DFilling = std::move(shard.DSpare.back());
+            shard.DSpare.pop_back();
+        }
+        shard.DFillCount = 0;
+        Lock.unlock();
+        shard.DCondition.notify_all();
+    }
+    
+    bool WriteRow(const std::vector<std::string> &row){
+        if(DShards.empty()){
+            return false;
+        }
+        SShard &Shard = *DShards[ShardOf(row)];
+        if(Shard.DError){
+            // an earlier write to this shard failed, reported until Flush
+            return false;
+        }
+        if(Shard.DFillCount < Shard.DFilling.size()){
+            // assign into the recycled row to reuse its strings' storage
+            auto &Slot = Shard.DFilling[Shard.DFillCount];
+            Slot.resize(row.size());
+            for(std::size_t Index = 0; Index < row.size(); Index++){
+                Slot[Index].assign(row[Index]);
+            }
+        }
+        else{
+            Shard.DFilling.push_back(row);
+        }
+        Shard.DFillCount++;
+        if(Shard.DFillCount >= DBatchSize){
+            Submit(Shard);
+        }
+        return true;
+    }
+    
+    bool Flush(){
+        bool Success = true;
+        for(auto &Shard : DShards){
+            Submit(*Shard);
+        }
+        for(auto &Shard : DShards){
+            std::unique_lock<std::mutex> Lock(Shard->DMutex);
+            Shard->DCondition.wait(Lock, [&Shard]{ return Shard->DQueue.empty() && !Shard->DBusy; });
+            Success = Shard->DSink->Flush() && Success;
+            Success = !Shard->DError.exchange(false) && Success;
+        }
+        return Success;
+    }
+};
+
+CShardedDSVWriter::CShardedDSVWriter(std::vector< std::shared_ptr< CDataSink > > sinks, const std::vector< std::size_t > &keycolumns, char delimiter, bool quoteall) 
+    : DImplementation(std::make_unique<SImplementation>(std::move(sinks), keycolumns, delimiter, quoteall)){
+
+}
+
+CShardedDSVWriter::~CShardedDSVWriter(){
+
+}
+
+std::size_t CShardedDSVWriter::ShardCount() const{
+    return DImplementation->DShards.size();
+}
+
+std::size_t CShardedDSVWriter::ShardOf(const std::vector<std::string> &row) const{
+    return DImplementation->ShardOf(row);
+}
+
+// Rows the shard has written so far, complete after Flush
+std::size_t CShardedDSVWriter::RowCount(std::size_t shard) const{
+    if(shard >= DImplementation->DShards.size()){
+        return 0;
+    }
+    return DImplementation->DShards[shard]->DRows.load();
+}
+
+bool CShardedDSVWriter::WriteRow(const std::vector<std::string> &row){
+    return DImplementation->WriteRow(row);
+}
+
+// Waits for every shard to write its queued rows, false if any write failed
+bool CShardedDSVWriter::Flush(){
+    return DImplementation->Flush();
+}
@@ -0,0 +1,79 @@
+#include "SharedBufferDataSource.h"
+
+CSharedBufferDataSource::CSharedBufferDataSource(std::string_view borrowed) : DSegment(0), DIndex(0){
+    if(!borrowed.empty()){
+        DSegments.push_back(borrowed);
+    }
+}
+
+CSharedBufferDataSource::CSharedBufferDataSource(std::shared_ptr< const std::string > buffer) : DSegment(0), DIndex(0){
+    if(buffer && !buffer->empty()){
+        DSegments.push_back(*buffer);
+        DOwners.push_back(std::move(buffer));
+    }
+}
+
+CSharedBufferDataSource::CSharedBufferDataSource(std::vector< TSegment > segments) : DSegment(0), DIndex(0){
+    for(auto &Segment : segments){
+        if(Segment && !Segment->empty()){
+            DSegments.emplace_back(Segment->data(), Segment->size());
+            DOwners.push_back(std::move(Segment));
+        }
+    }
+}
+
+// Moves past a segment that has been read to the end
+void CSharedBufferDataSource::Normalize() noexcept{
+    while(DSegment < DSegments.size() && DIndex >= DSegments[DSegment].size()){
+        DSegment++;
+        DIndex = 0;
+    }
+}
+
+bool CSharedBufferDataSource::End() const noexcept{
+    return DSegment >= DSegments.size();
+}
+
+bool CSharedBufferDataSource::Get(char &ch) noexcept{
+    if(End()){
+        return false;
+    }
+    ch = DSegments[DSegment][DIndex++];
+    Normalize();
+    return true;
+}
+
+bool CSharedBufferDataSource::Peek(char &ch) noexcept{
+    if(End()){
+        return false;
+    }
+    ch = DSegments[DSegment][DIndex];
+    return true;
+}
+
+// Copies up to count bytes into buf, crossing segments as needed
+bool CSharedBufferDataSource::Read(std::vector<char> &buf, std::size_t count) noexcept{
+    buf.clear();
+    while(count && !End()){
+        std::string_view Rest = DSegments[DSegment].substr(DIndex, count);
+        buf.insert(buf.end(), Rest.begin(), Rest.end());
+        DIndex += Rest.size();
+        count -= Rest.size();
+        Normalize();
+    }
+    return !buf.empty();
+}
+
+bool CSharedBufferDataSource::Seek(std::size_t offset) noexcept{
+    std::size_t Segment = 0;
+    while(Segment < DSegments.size() && offset >= DSegments[Segment].size()){
+        offset -= DSegments[Segment].size();
+        Segment++;
+    }
+    if(Segment == DSegments.size() && offset){
+        return false;
+    }
+    DSegment = Segment;
+    DIndex = offset;
+    return true;
+}
@@ -5,11 +5,11 @@ const std::string &CStringDataSink::String() const{
 }
 
 bool CStringDataSink::Put(const char &ch) noexcept{
-    DString += std::string(1,ch);
+    DString += ch;
     return true;
 }
 
 bool CStringDataSink::Write(const std::vector<char> &buf) noexcept{
-    DString += std::string(buf.data(),buf.size());
+    DString.append(buf.data(),buf.size());
     return true;
 }
\ No newline at end of file
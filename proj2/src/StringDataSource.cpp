@@ -26,15 +26,17 @@ bool CStringDataSource::Peek(char &ch) noexcept{
 }
 
 bool CStringDataSource::Read(std::vector<char> &buf, std::size_t count) noexcept{
-    buf.clear();
-    while(buf.size() < count){
-        char TempChar;
-        if(Get(TempChar)){
-            buf.push_back(TempChar);
-        }
-        else{
-            break;
-        }
-    }
+    std::size_t Available = DIndex < DString.length() ? DString.length() - DIndex : 0;
+    std::size_t Length = count < Available ? count : Available;
+    buf.assign(DString.begin() + DIndex, DString.begin() + DIndex + Length);
+    DIndex += Length;
     return !buf.empty();
 }
+
+bool CStringDataSource::Seek(std::size_t offset) noexcept{
+    if(offset > DString.length()){
+        return false;
+    }
+    DIndex = offset;
+    return true;
+}
@@ -1,5 +1,11 @@
 #include "StringUtils.h"
 #include <sstream> //included to work with stringstream
+#include <algorithm>
+#include <deque>
+#include <string_view>
+#if defined(__SSE2__)
+#include <emmintrin.h> //SSE2 intrinsics for the case conversion fast path
+#endif
 
 namespace StringUtils{
 
@@ -18,31 +24,99 @@ std::string Slice(const std::string &str, ssize_t first, ssize_t last) noexcept{
     return str.substr(first, last - first);
 }
 
+namespace{
+
+// 256 entry case tables, non-ASCII bytes map to themselves so UTF-8 passes
+// through untouched and the result does not depend on the global locale
+struct SCaseTables{
+    char DUpper[256];
+    char DLower[256];
+    constexpr SCaseTables() : DUpper(), DLower(){
+        for(int Index = 0; Index < 256; Index++){
+            DUpper[Index] = static_cast<char>((Index >= 'a' && Index <= 'z') ? Index - ('a' - 'A') : Index);
+            DLower[Index] = static_cast<char>((Index >= 'A' && Index <= 'Z') ? Index + ('a' - 'A') : Index);
+        }
+    }
+};
+
+constexpr SCaseTables CaseTables;
+
+// flips the case bit of every byte in [first, first + 25] of buf, 16 bytes at
+// a time when SSE2 is available, returns how many bytes were handled
+std::size_t FlipCaseRangeSIMD(char *buf, std::size_t len, char first) noexcept{
+    std::size_t Index = 0;
+#if defined(__SSE2__)
+    // shift the range so it starts at -128, then one signed compare is an
+    // unsigned range check
+    const __m128i Shift = _mm_set1_epi8(static_cast<char>(0x80 - first));
+    const __m128i Limit = _mm_set1_epi8(static_cast<char>(-128 + 26));
+    const __m128i CaseBit = _mm_set1_epi8(0x20);
+    for(; Index + 16 <= len; Index += 16){
+        __m128i Chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf + Index));
+        __m128i InRange = _mm_cmplt_epi8(_mm_add_epi8(Chunk, Shift), Limit);
+        Chunk = _mm_xor_si128(Chunk, _mm_and_si128(InRange, CaseBit));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(buf + Index), Chunk);
+    }
+#else
+    (void)buf;
+    (void)len;
+    (void)first;
+#endif
+    return Index;
+}
+
+}
+
+void UpperInPlace(char *buf, std::size_t len) noexcept{
+    std::size_t Index = FlipCaseRangeSIMD(buf, len, 'a'); //bulk of buffer
+    for(; Index < len; ++Index) { //remaining tail bytes
+        buf[Index] = CaseTables.DUpper[static_cast<unsigned char>(buf[Index])];
+    }
+}
+
+void LowerInPlace(char *buf, std::size_t len) noexcept{
+    std::size_t Index = FlipCaseRangeSIMD(buf, len, 'A'); //bulk of buffer
+    for(; Index < len; ++Index) { //remaining tail bytes
+        buf[Index] = CaseTables.DLower[static_cast<unsigned char>(buf[Index])];
+    }
+}
+
+void CapitalizeInPlace(char *buf, std::size_t len) noexcept{
+    if(len == 0) { //nothing to capitalize
+        return;
+    }
+    buf[0] = CaseTables.DUpper[static_cast<unsigned char>(buf[0])]; //capitalize first letter
+    LowerInPlace(buf + 1, len - 1); //uncapitalize rest of string (like python)
+}
+
+void UpperInPlace(std::string &str) noexcept{
+    UpperInPlace(&str[0], str.size());
+}
+
+void LowerInPlace(std::string &str) noexcept{
+    LowerInPlace(&str[0], str.size());
+}
+
+void CapitalizeInPlace(std::string &str) noexcept{
+    CapitalizeInPlace(&str[0], str.size());
+}
+
 //returns capitalized string (first letter only capitalized)
 std::string Capitalize(const std::string &str) noexcept{
     std::string first = str;
-    first[0] = toupper(first[0]); //capitalize first letter
-
-    //uncapitalize rest of string using loop (like python)
-    for(std::size_t i = 1 ; i < first.length() ; ++i) {
-        first[i] = tolower(first[i]);
-    }
+    CapitalizeInPlace(first);
     return first;
 }
 
 std::string Upper(const std::string &str) noexcept{
     std::string all_str = str;
-    for (size_t i = 0; i < all_str.size(); ++i) {
-        all_str[i] = toupper(all_str[i]);
-    }
+    UpperInPlace(all_str);
     return all_str;
 }
 
 std::string Lower(const std::string &str) noexcept{
-     std::string all_str = str;
-    for (size_t i = 0; i < all_str.size(); ++i) {
-        all_str[i] = tolower(all_str[i]);
-    }
+    std::string all_str = str;
+    LowerInPlace(all_str);
     return all_str;
 }
 
@@ -164,8 +238,8 @@ int EditDistance(const std::string &left, const std::string &right, bool ignorec
     std::string left_str = left;
     std::string right_str = right;
     if (ignorecase) { //if ignorecase is true
-        left_str = Lower(left_str); //convert left string to lowercase
-        right_str = Lower(right_str); //convert right string to lowercase
+        LowerInPlace(left_str); //convert left string to lowercase
+        LowerInPlace(right_str); //convert right string to lowercase
     }
     int left_len = left_str.length(); //get length of left string
     int right_len = right_str.length(); //get length of right string
@@ -193,4 +267,218 @@ int EditDistance(const std::string &left, const std::string &right, bool ignorec
     return matrix[left_len][right_len]; //return final cost
 }
 
+// Automaton over all patterns. Transitions are a full table so each input
+// byte costs one lookup. DMatch is the pattern ending at a state, DMatchLink
+// the next shorter pattern that is a suffix of the state's string and DFail
+// the longest proper suffix that is a state.
+struct CMultiReplacer::SImplementation{
+    static constexpr std::size_t NoPattern = static_cast<std::size_t>(-1);
+    static constexpr std::size_t ChunkSize = 65536;
+    
+    std::vector< std::pair< std::string, std::string > > DPairs;
+    std::vector< std::size_t > DNext;       // 256 transitions per state
+    std::vector< std::size_t > DDepth;
+    std::vector< std::size_t > DMatch;
+    std::vector< std::size_t > DMatchLink;
+    std::vector< std::size_t > DFail;
+    
+    // Position of a scan, kept between chunks when streaming. Offsets are
+    // into the text handed to Run.
+    struct SScan{
+        std::size_t DState = 0;
+        std::size_t DPosition = 0;      // bytes fed to the automaton
+        std::size_t DFlushed = 0;       // bytes already written out
+        std::size_t DCandidate = NoPattern;
+        std::size_t DCandidateStart = 0;
+        std::deque< std::size_t > DLongest;    // longest pattern seen starting at each byte from DFlushed on
+    };
+    
+    SImplementation(const std::vector< std::pair< std::string, std::string > > &replacements){
+        AddState(0);
+        for(auto &Pair : replacements){
+            if(Pair.first.empty()){
+                continue;
+            }
+            std::size_t State = 0;
+            for(unsigned char Ch : Pair.first){
+                if(!DNext[State * 256 + Ch]){
+                    DNext[State * 256 + Ch] = AddState(DDepth[State] + 1);
+                }
+                State = DNext[State * 256 + Ch];
+            }
+            if(DMatch[State] == NoPattern){
+                DMatch[State] = DPairs.size();
+                DPairs.push_back(Pair);
+            }
+        }
+        // breadth first so a state's failure link is complete before its
+        // children are linked
+        DFail.assign(DDepth.size(), 0);
+        std::vector< std::size_t > Queue;
+        for(std::size_t Ch = 0; Ch < 256; Ch++){
+            if(DNext[Ch]){
+                Queue.push_back(DNext[Ch]);
+            }
+        }
+        for(std::size_t Index = 0; Index < Queue.size(); Index++){
+            std::size_t State = Queue[Index];
+            std::size_t Link = DFail[State];
+            DMatchLink[State] = DMatch[Link] != NoPattern ? Link : DMatchLink[Link];
+            for(std::size_t Ch = 0; Ch < 256; Ch++){
+                std::size_t &Next = DNext[State * 256 + Ch];
+                if(Next){
+                    DFail[Next] = DNext[Link * 256 + Ch];
+                    Queue.push_back(Next);
+                }
+                else{
+                    Next = DNext[Link * 256 + Ch];
+                }
+            }
+        }
+    };
+    
+    std::size_t AddState(std::size_t depth){
+        DNext.resize(DNext.size() + 256, 0);
+        DDepth.push_back(depth);
+        DMatch.push_back(NoPattern);
+        DMatchLink.push_back(0);
+        return DDepth.size() - 1;
+    };
+    
+    // Writes out text up to keep, which no match can start before
+    void Flush(std::string_view text, SScan &scan, std::string &out, std::size_t keep) const{
+        out.append(text.substr(scan.DFlushed, keep - scan.DFlushed));
+        scan.DLongest.erase(scan.DLongest.begin(), scan.DLongest.begin() + (keep - scan.DFlushed));
+        scan.DFlushed = keep;
+    };
+    
+    // Replaces the candidate. The automaton keeps its place, only dropping
+    // the part of its partial match that lies inside the replaced text, and
+    // the next candidate is the leftmost match already seen after it, so no
+    // byte is fed twice.
+    void Commit(std::string_view text, SScan &scan, std::string &out) const{
+        const auto &Pair = DPairs[scan.DCandidate];
+        std::size_t End = scan.DCandidateStart + Pair.first.size();
+        Flush(text, scan, out, scan.DCandidateStart);
+        out.append(Pair.second);
+        scan.DLongest.erase(scan.DLongest.begin(), scan.DLongest.begin() + Pair.first.size());
+        scan.DFlushed = End;
+        while(DDepth[scan.DState] > scan.DPosition - End){
+            scan.DState = DFail[scan.DState];
+        }
+        scan.DCandidate = NoPattern;
+        for(std::size_t Index = 0; Index < scan.DLongest.size(); Index++){
+            if(scan.DLongest[Index] != NoPattern){
+                scan.DCandidate = scan.DLongest[Index];
+                scan.DCandidateStart = End + Index;
+                break;
+            }
+        }
+    };
+    
+    // Feeds text from scan.DPosition on and writes out everything that can no
+    // longer be part of a match. Every byte is fed once, so the time is
+    // linear in the text plus the pattern occurrences found. With last set
+    // the text is complete and all of it is written.
+    void Run(std::string_view text, SScan &scan, std::string &out, bool last) const{
+        while(scan.DPosition < text.size()){
+            scan.DState = DNext[scan.DState * 256 + static_cast<unsigned char>(text[scan.DPosition])];
+            scan.DPosition++;
+            scan.DLongest.push_back(NoPattern);
+            std::size_t Found = DMatch[scan.DState] != NoPattern ? scan.DState : DMatchLink[scan.DState];
+            // patterns ending here, longest first
+            for(; Found; Found = DMatchLink[Found]){
+                std::size_t Start = scan.DPosition - DDepth[Found];
+                std::size_t &Longest = scan.DLongest[Start - scan.DFlushed];
+                if(Longest == NoPattern || DDepth[Found] > DPairs[Longest].first.size()){
+                    Longest = DMatch[Found];
+                }
+                if(scan.DCandidate == NoPattern || Start < scan.DCandidateStart){
+                    scan.DCandidate = DMatch[Found];
+                    scan.DCandidateStart = Start;
+                }
+                else if(Start == scan.DCandidateStart && DDepth[Found] > DPairs[scan.DCandidate].first.size()){
+                    scan.DCandidate = DMatch[Found];
+                }
+            }
+            // no partial match reaches back to the candidate's start
+            while(scan.DCandidate != NoPattern && scan.DPosition - DDepth[scan.DState] > scan.DCandidateStart){
+                Commit(text, scan, out);
+            }
+            // with nothing pending, bytes before the partial match are final
+            std::size_t Earliest = scan.DPosition - DDepth[scan.DState];
+            if(scan.DCandidate == NoPattern && Earliest - scan.DFlushed >= ChunkSize){
+                Flush(text, scan, out, Earliest);
+            }
+        }
+        while(last && scan.DCandidate != NoPattern){
+            Commit(text, scan, out);
+        }
+        std::size_t Keep = last ? text.size() : scan.DPosition - DDepth[scan.DState];
+        if(scan.DCandidate != NoPattern){
+            Keep = std::min(Keep, scan.DCandidateStart);
+        }
+        if(Keep > scan.DFlushed){
+            Flush(text, scan, out, Keep);
+        }
+    };
+};
+
+CMultiReplacer::CMultiReplacer(const std::vector< std::pair< std::string, std::string > > &replacements) 
+    : DImplementation(std::make_unique<SImplementation>(replacements)){
+    
+}
+
+CMultiReplacer::~CMultiReplacer(){
+    
+}
+
+// Returns str with every replacement applied
+std::string CMultiReplacer::Replace(const std::string &str) const noexcept{
+    std::string Result;
+    Result.reserve(str.size());
+    SImplementation::SScan Scan;
+    DImplementation->Run(str, Scan, Result, true);
+    return Result;
+}
+
+// Copies src to sink applying the replacements, a match may span the chunks
+// src is read in. Only the bytes that could still start a match are held.
+bool CMultiReplacer::Replace(CDataSource &src, CDataSink &sink) const noexcept{
+    std::vector<char> Chunk;
+    std::string Pending;
+    std::string Output;
+    std::vector<char> Buffer;
+    SImplementation::SScan Scan;
+    bool More = true;
+    while(More){
+        More = src.Read(Chunk, SImplementation::ChunkSize);
+        if(More){
+            Pending.append(Chunk.data(), Chunk.size());
+        }
+        DImplementation->Run(Pending, Scan, Output, !More);
+        // drop what was written out, offsets move with the text
+        Pending.erase(0, Scan.DFlushed);
+        Scan.DPosition -= Scan.DFlushed;
+        if(Scan.DCandidate != SImplementation::NoPattern){
+            Scan.DCandidateStart -= Scan.DFlushed;
+        }
+        Scan.DFlushed = 0;
+        if(!Output.empty()){
+            Buffer.assign(Output.begin(), Output.end());
+            Output.clear();
+            if(!sink.Write(Buffer)){
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Single pass replacement of several patterns, see CMultiReplacer
+std::string Replace(const std::string &str, const std::vector< std::pair< std::string, std::string > > &replacements) noexcept{
+    return CMultiReplacer(replacements).Replace(str);
+}
+
+
 };
\ No newline at end of file
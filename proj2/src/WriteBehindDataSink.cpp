@@ -0,0 +1,131 @@
+#include "WriteBehindDataSink.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+struct CWriteBehindDataSink::SImplementation{
+    std::shared_ptr< CDataSink > DSink;
+    std::size_t DBufferSize;
+    std::vector<char> DCurrent;                 // buffer being filled by the writer
+    
+    // Single producer single consumer ring, DHead and DTail only ever grow.
+    // The writer owns DTail and the slots past it, the worker owns DHead and
+    // advances it once a slot has been written out so its storage can be
+    // swapped back to the writer.
+    std::vector< std::vector<char> > DSlots;
+    std::atomic<std::size_t> DHead;
+    std::atomic<std::size_t> DTail;
+    std::atomic<bool> DError;
+    std::atomic<bool> DStop;
+    
+    // Only used to sleep when the ring is full or empty
+    std::mutex DMutex;
+    std::condition_variable DCondition;
+    std::thread DWorker;
+    
+    SImplementation(std::shared_ptr< CDataSink > sink, std::size_t buffersize, std::size_t queuedepth) 
+        : DSink(std::move(sink)), DBufferSize(buffersize ? buffersize : 1), DSlots(queuedepth ? queuedepth : 1), 
+          DHead(0), DTail(0), DError(false), DStop(false){
+        DCurrent.reserve(DBufferSize);
+        DWorker = std::thread([this]{ WorkerLoop(); });
+    }
+    
+    ~SImplementation(){
+        Flush();
+        DStop.store(true);
+        Notify();
+        DWorker.join();
+    }
+    
+    void Notify(){
+        {
+            std::lock_guard<std::mutex> Lock(DMutex);
+        }
+        DCondition.notify_all();
+    }
+    
+    void WorkerLoop(){
+        while(true){
+            std::size_t Head = DHead.load(std::memory_order_relaxed);
+            if(Head == DTail.load(std::memory_order_acquire)){
+                std::unique_lock<std::mutex> Lock(DMutex);
+                DCondition.wait(Lock, [this, Head]{ return DStop.load() || Head != DTail.load(std::memory_order_acquire); });
+                if(Head == DTail.load(std::memory_order_acquire)){
+                    return;
+                }
+            }
+            std::vector<char> &Slot = DSlots[Head % DSlots.size()];
+            if(!DError.load(std::memory_order_relaxed) && !DSink->Write(Slot)){
+                DError.store(true);
+            }
+            Slot.clear();
+            DHead.store(Head + 1, std::memory_order_release);
+            Notify();
+        }
+    }
+    
+    // Queues the current buffer, blocking while the ring is full
+    void Submit(){
+        if(DCurrent.empty()){
+            return;
+        }
+        std::size_t Tail = DTail.load(std::memory_order_relaxed);
+        if(Tail - DHead.load(std::memory_order_acquire) == DSlots.size()){
+            std::unique_lock<std::mutex> Lock(DMutex);
+            DCondition.wait(Lock, [this, Tail]{ return Tail - DHead.load(std::memory_order_acquire) < DSlots.size(); });
+        }
+        DSlots[Tail % DSlots.size()].swap(DCurrent);
+        DTail.store(Tail + 1, std::memory_order_release);
+        Notify();
+        DCurrent.reserve(DBufferSize);
+    }
+    
+    bool Append(const char *data, std::size_t length){
+        if(DError.load(std::memory_order_relaxed)){
+            return false;
+        }
+        DCurrent.insert(DCurrent.end(), data, data + length);
+        if(DCurrent.size() >= DBufferSize){
+            Submit();
+        }
+        return true;
+    }
+    
+    // Queues what is buffered and waits for the worker to write everything
+    bool Flush(){
+        Submit();
+        std::size_t Tail = DTail.load(std::memory_order_relaxed);
+        if(DHead.load(std::memory_order_acquire) != Tail){
+            std::unique_lock<std::mutex> Lock(DMutex);
+            DCondition.wait(Lock, [this, Tail]{ return DHead.load(std::memory_order_acquire) == Tail; });
+        }
+        // the worker is idle until the next Submit, so the sink can be flushed here
+        if(DError.load() || !DSink->Flush()){
+            DError.store(true);
+            return false;
+        }
+        return true;
+    }
+};
+
+CWriteBehindDataSink::CWriteBehindDataSink(std::shared_ptr< CDataSink > sink, std::size_t buffersize, std::size_t queuedepth) 
+    : DImplementation(std::make_unique<SImplementation>(std::move(sink), buffersize, queuedepth)){
+
+}
+
+CWriteBehindDataSink::~CWriteBehindDataSink(){
+
+}
+
+bool CWriteBehindDataSink::Put(const char &ch) noexcept{
+    return DImplementation->Append(&ch, 1);
+}
+
+bool CWriteBehindDataSink::Write(const std::vector<char> &buf) noexcept{
+    return DImplementation->Append(buf.data(), buf.size());
+}
+
+bool CWriteBehindDataSink::Flush() noexcept{
+    return DImplementation->Flush();
+}
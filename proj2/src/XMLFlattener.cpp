@@ -0,0 +1,179 @@
+#include "XMLFlattener.h"
+#include <string_view>
+#include <unordered_map>
+#include <expat.h>
+
+struct CXMLFlattener::SImplementation{
+    static constexpr std::size_t ChunkSize = 65536;
+    
+    // Slots filled from one element: its text and its attributes
+    struct SElementPlan{
+        std::vector< std::size_t > DTextSlots;
+        std::vector< std::pair< std::string_view, std::size_t > > DAttributeSlots;
+    };
+    
+    std::string DRecord;
+    std::vector< SXMLFlattenColumn > DColumns;
+    SElementPlan DRecordPlan;
+    std::unordered_map< std::string_view, SElementPlan > DChildPlans;
+    
+    // Per document state
+    std::vector< std::string > DValues;
+    std::vector< std::string_view > DViews;
+    std::size_t DDepth;
+    std::size_t DRecordDepth;           // 0 when outside a record
+    const SElementPlan *DCapture;       // child whose text is being collected
+    std::size_t DCaptureDepth;
+    std::size_t DRecordCount;
+    CDSVWriter *DWriter;
+    bool DWriteFailed;
+    
+    SImplementation(const std::string &record, const std::vector< SXMLFlattenColumn > &columns)
+        : DRecord(record), DColumns(columns), DValues(columns.size()), DViews(columns.size()), DDepth(0), DRecordDepth(0), 
+          DCapture(nullptr), DCaptureDepth(0), DRecordCount(0), DWriter(nullptr), DWriteFailed(false){
+        // views point into DColumns, which is not modified after this
+        for(std::size_t Slot = 0; Slot < DColumns.size(); Slot++){
+            const auto &Column = DColumns[Slot];
+            switch(Column.DKind){
+                case SXMLFlattenColumn::EKind::Attribute:
+                    DRecordPlan.DAttributeSlots.emplace_back(Column.DAttribute, Slot);
+                    break;
+                case SXMLFlattenColumn::EKind::ChildText:
+                    DChildPlans[Column.DElement].DTextSlots.push_back(Slot);
+                    break;
+                case SXMLFlattenColumn::EKind::ChildAttribute:
+                    DChildPlans[Column.DElement].DAttributeSlots.emplace_back(Column.DAttribute, Slot);
+                    break;
+            }
+        }
+    }
+    
+    void ApplyAttributes(const SElementPlan &plan, const char **atts){
+        for(auto &AttributeSlot : plan.DAttributeSlots){
+            for(int Index = 0; atts[Index]; Index += 2){
+                if(AttributeSlot.first == atts[Index]){
+                    DValues[AttributeSlot.second].assign(atts[Index + 1]);
+                    break;
+                }
+            }
+        }
+    }
+    
+    static void StartElementHandler(void *userData, const char *name, const char **atts){
+        SImplementation *Impl = static_cast<SImplementation *>(userData);
+        Impl->DDepth++;
+        if(!Impl->DRecordDepth){
+            if(Impl->DRecord == name){
+                Impl->DRecordDepth = Impl->DDepth;
+                for(auto &Value : Impl->DValues){
+                    Value.clear();
+                }
+                Impl->ApplyAttributes(Impl->DRecordPlan, atts);
+            }
+            return;
+        }
+        if(Impl->DDepth == Impl->DRecordDepth + 1){
+            auto Plan = Impl->DChildPlans.find(std::string_view(name));
+            if(Plan != Impl->DChildPlans.end()){
+                Impl->ApplyAttributes(Plan->second, atts);
+                if(!Plan->second.DTextSlots.empty()){
+                    Impl->DCapture = &Plan->second;
+                    Impl->DCaptureDepth = Impl->DDepth;
+                }
+            }
+        }
+    }
+    
+    static void EndElementHandler(void *userData, const char *){
+        SImplementation *Impl = static_cast<SImplementation *>(userData);
+        if(Impl->DCapture && Impl->DDepth == Impl->DCaptureDepth){
+            Impl->DCapture = nullptr;
+        }
+        if(Impl->DRecordDepth && Impl->DDepth == Impl->DRecordDepth){
+            Impl->DRecordDepth = 0;
+            Impl->DRecordCount++;
+            for(std::size_t Slot = 0; Slot < Impl->DValues.size(); Slot++){
+                Impl->DViews[Slot] = Impl->DValues[Slot];
+            }
+            if(!Impl->DWriter->WriteRow(Impl->DViews.data(), Impl->DViews.size())){
+                Impl->DWriteFailed = true;
+            }
+        }
+        Impl->DDepth--;
+    }
+    
+    static void CharDataHandler(void *userData, const char *data, int len){
+        SImplementation *Impl = static_cast<SImplementation *>(userData);
+        if(Impl->DCapture){
+            for(auto Slot : Impl->DCapture->DTextSlots){
+                Impl->DValues[Slot].append(data, len);
+            }
+        }
+    }
+    
+    bool Flatten(std::shared_ptr< CDataSource > src, CDSVWriter &writer){
+        XML_Parser Parser = XML_ParserCreate(nullptr);
+        XML_SetUserData(Parser, this);
+        XML_SetElementHandler(Parser, StartElementHandler, EndElementHandler);
+        XML_SetCharacterDataHandler(Parser, CharDataHandler);
+        DDepth = 0;
+        DRecordDepth = 0;
+        DCapture = nullptr;
+        DWriter = &writer;
+        DWriteFailed = false;
+        
+        std::vector<char> Buffer;
+        bool Success = true;
+        while(Success && src->Read(Buffer, ChunkSize)){
+            Success = XML_Parse(Parser, Buffer.data(), Buffer.size(), XML_FALSE) != XML_STATUS_ERROR;
+        }
+        Success = Success && XML_Parse(Parser, nullptr, 0, XML_TRUE) != XML_STATUS_ERROR;
+        XML_ParserFree(Parser);
+        DWriter = nullptr;
+        return Success && !DWriteFailed;
+    }
+};
+
+CXMLFlattener::CXMLFlattener(const std::string &record, const std::vector< SXMLFlattenColumn > &columns)
+    : DImplementation(std::make_unique<SImplementation>(record, columns)){
+
+}
+
+CXMLFlattener::~CXMLFlattener(){
+
+}
+
+// Column names, the attribute or element name with child attributes written
+// as element@attribute
+std::vector< std::string > CXMLFlattener::Header() const{
+    std::vector< std::string > Names;
+    for(auto &Column : DImplementation->DColumns){
+        switch(Column.DKind){
+            case SXMLFlattenColumn::EKind::Attribute:
+                Names.push_back(Column.DAttribute);
+                break;
+            case SXMLFlattenColumn::EKind::ChildText:
+                Names.push_back(Column.DElement);
+                break;
+            case SXMLFlattenColumn::EKind::ChildAttribute:
+                Names.push_back(Column.DElement + "@" + Column.DAttribute);
+                break;
+        }
+    }
+    return Names;
+}
+
+// Records written by the most recent Flatten
+std::size_t CXMLFlattener::RecordCount() const{
+    return DImplementation->DRecordCount;
+}
+
+// Writes one row per record of src to writer, preceded by the header row if
+// requested, false on malformed XML or a failed write
+bool CXMLFlattener::Flatten(std::shared_ptr< CDataSource > src, CDSVWriter &writer, bool header){
+    DImplementation->DRecordCount = 0;
+    if(header && !writer.WriteRow(Header())){
+        return false;
+    }
+    return DImplementation->Flatten(std::move(src), writer);
+}
@@ -2,22 +2,33 @@
 #include "XMLWriter.h"
 #include "DataSource.h"
 #include "DataSink.h"
+#include <deque>
 #include <iostream>
 #include <sstream>
 #include <stack>
+#include <cstring>
 #include <expat.h>
 
 // Implementation for XML Reader
 struct CXMLReader::SImplementation {
+    static constexpr std::size_t ChunkSize = 65536; // Bytes read per parse call
     std::shared_ptr<CDataSource> Source;
     XML_Parser Parser;
     std::deque<SXMLEntity> EntityQueue; // Queue to store parsed entities
+    std::pmr::unsynchronized_pool_resource QueueResource; // Owns queued pmr entities, the caller's resource may be released between reads
+    std::deque<SPmrXMLEntity> PmrEntityQueue; // Parsed entities while reading into a memory resource
+    std::vector<char> Buffer; // Chunk handed to expat, reused between reads
+    static constexpr char NamespaceSeparator = '\n'; // Cannot occur in a namespace URI or name
     bool EndOfFile;
     bool SkipCData;
+    bool Namespaces; // Parser reports names as URI, separator, local name
+    bool PmrRead; // Reading into an SPmrXMLEntity, entities are queued in QueueResource
+    CXMLHandler *Handler; // Receives events directly while Parse runs
+    std::vector<SXMLAttributeView> AttributeViews; // Reused for each start element
 
-    SImplementation(std::shared_ptr<CDataSource> src)
-        : Source(src), EndOfFile(false), SkipCData(false) {
-        Parser = XML_ParserCreate(nullptr);
+    SImplementation(std::shared_ptr<CDataSource> src, bool namespaces)
+        : Source(src), EndOfFile(false), SkipCData(false), Namespaces(namespaces), PmrRead(false), Handler(nullptr) {
+        Parser = namespaces ? XML_ParserCreateNS(nullptr, NamespaceSeparator) : XML_ParserCreate(nullptr);
         XML_SetUserData(Parser, this);
         XML_SetElementHandler(Parser, StartElementHandler, EndElementHandler);
         XML_SetCharacterDataHandler(Parser, CharDataHandler);
@@ -28,13 +39,20 @@ struct CXMLReader::SImplementation {
     }
 
     bool ReadEntity(SXMLEntity &entity, bool skipcdata);
+    bool ReadEntity(SPmrXMLEntity &entity, bool skipcdata);
+    bool ParseUntilQueued();
+    bool Parse(CXMLHandler &handler, bool skipcdata);
+    SXMLName SplitName(const char *name) const;
+    std::string EntityName(const char *name) const;
+    void AssignName(std::pmr::string &target, const char *name) const;
     static void StartElementHandler(void *userData, const char *name, const char **atts);
     static void EndElementHandler(void *userData, const char *name);
     static void CharDataHandler(void *userData, const char *data, int len);
 };
 
-// Constructor for XML Reader
-CXMLReader::CXMLReader(std::shared_ptr<CDataSource> src) : DImplementation(std::make_unique<SImplementation>(src)) {}
+// Constructor for XML Reader, when namespaces is set names are resolved
+// against their namespace declarations
+CXMLReader::CXMLReader(std::shared_ptr<CDataSource> src, bool namespaces) : DImplementation(std::make_unique<SImplementation>(src, namespaces)) {}
 
 // Destructor for XML Reader
 CXMLReader::~CXMLReader() {}
@@ -47,32 +65,149 @@ bool CXMLReader::ReadEntity(SXMLEntity &entity, bool skipcdata) {
     return DImplementation->ReadEntity(entity, skipcdata);
 }
 
-bool CXMLReader::SImplementation::ReadEntity(SXMLEntity &entity, bool skipcdata) {
+// Parse the rest of the data source passing every event straight to handler
+// instead of queuing entities, entities already queued are left for ReadEntity
+bool CXMLReader::Parse(CXMLHandler &handler, bool skipcdata) {
+    return DImplementation->Parse(handler, skipcdata);
+}
+
+bool CXMLReader::SImplementation::Parse(CXMLHandler &handler, bool skipcdata) {
     SkipCData = skipcdata;
+    Handler = &handler;
+    bool success = true;
+    while (success && !EndOfFile) {
+        if (!Source->Read(Buffer, ChunkSize)) {
+            EndOfFile = true;
+            success = XML_Parse(Parser, nullptr, 0, XML_TRUE) != XML_STATUS_ERROR; // Finalize parsing
+        }
+        else if (XML_Parse(Parser, Buffer.data(), Buffer.size(), XML_FALSE) == XML_STATUS_ERROR) {
+            EndOfFile = true;
+            success = false;
+        }
+    }
+    Handler = nullptr;
+    return success;
+}
 
-    // Keep parsing until we have entities or reach EOF
-    while (EntityQueue.empty() && !EndOfFile) {
-        std::vector<char> buffer(1024); // Create a buffer
-        size_t bytesRead = Source->Read(buffer, buffer.size()); // Pass the vector by reference
+// Split a name reported by the parser into namespace URI and local name
+SXMLName CXMLReader::SImplementation::SplitName(const char *name) const {
+    SXMLName result;
+    const char *separator = Namespaces ? std::strchr(name, NamespaceSeparator) : nullptr;
+    if (separator) {
+        result.DNamespace = std::string_view(name, separator - name);
+        result.DLocal = std::string_view(separator + 1);
+    }
+    else {
+        result.DLocal = std::string_view(name);
+    }
+    return result;
+}
 
-        if (bytesRead == 0) {
+// Name for an entity, namespaced names are written as {URI}local
+std::string CXMLReader::SImplementation::EntityName(const char *name) const {
+    SXMLName split = SplitName(name);
+    if (split.DNamespace.empty()) {
+        return std::string(split.DLocal);
+    }
+    std::string result;
+    result.reserve(split.DNamespace.size() + split.DLocal.size() + 2);
+    result += '{';
+    result += split.DNamespace;
+    result += '}';
+    result += split.DLocal;
+    return result;
+}
+
+// Parse chunks until an entity is queued, false on a parse error
+bool CXMLReader::SImplementation::ParseUntilQueued() {
+    // Keep parsing until we have entities or reach EOF
+    while (EntityQueue.empty() && PmrEntityQueue.empty() && !EndOfFile) {
+        if (!Source->Read(Buffer, ChunkSize)) { // Refill the reused buffer
             EndOfFile = true;
             XML_Parse(Parser, nullptr, 0, XML_TRUE); // Finalize parsing
             break;
         }
 
-        // Resize the buffer to the actual bytes read
-        buffer.resize(bytesRead);
-
         // Parse the chunk using the buffer's data
-        if (XML_Parse(Parser, buffer.data(), bytesRead, XML_FALSE) == XML_STATUS_ERROR) {
+        if (XML_Parse(Parser, Buffer.data(), Buffer.size(), XML_FALSE) == XML_STATUS_ERROR) {
             EndOfFile = true;
             return false;
         }
     }
+    return true;
+}
+
+// Same as EntityName, writing into a string from a memory resource
+void CXMLReader::SImplementation::AssignName(std::pmr::string &target, const char *name) const {
+    SXMLName split = SplitName(name);
+    target.clear();
+    if (!split.DNamespace.empty()) {
+        target += '{';
+        target += split.DNamespace;
+        target += '}';
+    }
+    target += split.DLocal;
+}
+
+bool CXMLReader::SImplementation::ReadEntity(SXMLEntity &entity, bool skipcdata) {
+    SkipCData = skipcdata;
+    PmrRead = false;
+    if (!ParseUntilQueued()) {
+        return false;
+    }
 
     if (!EntityQueue.empty()) {
-        entity = EntityQueue.front();
+        entity = std::move(EntityQueue.front());
+        EntityQueue.pop_front();
+        return true;
+    }
+    if (!PmrEntityQueue.empty()) { // Left over from a read into a memory resource
+        const SPmrXMLEntity &front = PmrEntityQueue.front();
+        entity.DType = front.DType;
+        entity.DNameData.assign(front.DNameData);
+        entity.DAttributes.clear();
+        for (auto &attribute : front.DAttributes) {
+            entity.DAttributes.emplace_back(std::string(attribute.first), std::string(attribute.second));
+        }
+        PmrEntityQueue.pop_front();
+        return true;
+    }
+
+    return false;
+}
+
+// Read an XML entity whose strings are allocated from the entity's memory resource
+bool CXMLReader::ReadEntity(SPmrXMLEntity &entity, bool skipcdata) {
+    return DImplementation->ReadEntity(entity, skipcdata);
+}
+
+bool CXMLReader::SImplementation::ReadEntity(SPmrXMLEntity &entity, bool skipcdata) {
+    SkipCData = skipcdata;
+    PmrRead = true;
+    if (!ParseUntilQueued()) {
+        return false;
+    }
+
+    if (!PmrEntityQueue.empty()) { // Copied into the caller's resource, reusing the entity's strings
+        const SPmrXMLEntity &front = PmrEntityQueue.front();
+        entity.DType = front.DType;
+        entity.DNameData.assign(front.DNameData);
+        entity.DAttributes.resize(front.DAttributes.size());
+        for (std::size_t i = 0; i < front.DAttributes.size(); i++) {
+            entity.DAttributes[i].first.assign(front.DAttributes[i].first);
+            entity.DAttributes[i].second.assign(front.DAttributes[i].second);
+        }
+        PmrEntityQueue.pop_front();
+        return true;
+    }
+    if (!EntityQueue.empty()) { // Left over from an SXMLEntity read
+        const SXMLEntity &front = EntityQueue.front();
+        entity.DType = front.DType;
+        entity.DNameData.assign(front.DNameData);
+        entity.DAttributes.clear();
+        for (auto &attribute : front.DAttributes) {
+            entity.DAttributes.emplace_back(attribute.first, attribute.second);
+        }
         EntityQueue.pop_front();
         return true;
     }
@@ -83,36 +218,76 @@ bool CXMLReader::SImplementation::ReadEntity(SXMLEntity &entity, bool skipcdata)
 // Handler for XML start elements
 void CXMLReader::SImplementation::StartElementHandler(void *userData, const char *name, const char **atts) {
     SImplementation *impl = static_cast<SImplementation*>(userData);
+    if (impl->Handler) { // Hand the event over without copying
+        impl->AttributeViews.clear();
+        for (int i = 0; atts[i] != nullptr; i += 2) {
+            impl->AttributeViews.push_back(SXMLAttributeView{impl->SplitName(atts[i]), std::string_view(atts[i + 1])});
+        }
+        impl->Handler->StartElement(impl->SplitName(name), impl->AttributeViews);
+        return;
+    }
+    if (impl->PmrRead) { // Build the entity in the reader's pool
+        impl->PmrEntityQueue.emplace_back(SPmrXMLEntity::allocator_type(&impl->QueueResource));
+        SPmrXMLEntity &entity = impl->PmrEntityQueue.back();
+        entity.DType = SXMLEntity::EType::StartElement;
+        impl->AssignName(entity.DNameData, name);
+        for (int i = 0; atts[i] != nullptr; i += 2) {
+            entity.DAttributes.emplace_back();
+            impl->AssignName(entity.DAttributes.back().first, atts[i]);
+            entity.DAttributes.back().second.assign(atts[i + 1]);
+        }
+        return;
+    }
     SXMLEntity entity;
     entity.DType = SXMLEntity::EType::StartElement;
-    entity.DNameData = name;
+    entity.DNameData = impl->EntityName(name);
 
     // Add attributes
     for (int i = 0; atts[i] != nullptr; i += 2) {
-        entity.DAttributes.emplace_back(atts[i], atts[i + 1]);
+        entity.DAttributes.emplace_back(impl->EntityName(atts[i]), atts[i + 1]);
     }
 
-    impl->EntityQueue.push_back(entity); // Add to queue
+    impl->EntityQueue.push_back(std::move(entity)); // Add to queue
 }
 
 void CXMLReader::SImplementation::EndElementHandler(void *userData, const char *name) {
     SImplementation *impl = static_cast<SImplementation*>(userData);
+    if (impl->Handler) {
+        impl->Handler->EndElement(impl->SplitName(name));
+        return;
+    }
+    if (impl->PmrRead) {
+        impl->PmrEntityQueue.emplace_back(SPmrXMLEntity::allocator_type(&impl->QueueResource));
+        impl->PmrEntityQueue.back().DType = SXMLEntity::EType::EndElement;
+        impl->AssignName(impl->PmrEntityQueue.back().DNameData, name);
+        return;
+    }
     SXMLEntity entity;
     entity.DType = SXMLEntity::EType::EndElement;
-    entity.DNameData = name;
+    entity.DNameData = impl->EntityName(name);
 
-    impl->EntityQueue.push_back(entity); // Add to queue
+    impl->EntityQueue.push_back(std::move(entity)); // Add to queue
 }
 
 void CXMLReader::SImplementation::CharDataHandler(void *userData, const char *data, int len) {
     SImplementation *impl = static_cast<SImplementation*>(userData);
     if (impl->SkipCData) return;
+    if (impl->Handler) {
+        impl->Handler->CharData(std::string_view(data, len));
+        return;
+    }
+    if (impl->PmrRead) {
+        impl->PmrEntityQueue.emplace_back(SPmrXMLEntity::allocator_type(&impl->QueueResource));
+        impl->PmrEntityQueue.back().DType = SXMLEntity::EType::CharData;
+        impl->PmrEntityQueue.back().DNameData.assign(data, len);
+        return;
+    }
 
     SXMLEntity entity;
     entity.DType = SXMLEntity::EType::CharData;
     entity.DNameData.assign(data, len);
 
-    impl->EntityQueue.push_back(entity); // Add to queue
+    impl->EntityQueue.push_back(std::move(entity)); // Add to queue
 }
 
 // CXMLReader::CXMLReader(std::shared_ptr< CDataSource > /*src*/) {
@@ -1,80 +1,126 @@
 #include "XMLWriter.h"
 #include "DataSink.h"
-#include "XMLWriter.h"
 #include <vector>
-#include <sstream>
-#include <stdexcept>
 
 // Private implementation of CXMLWriter using the Pimpl idiom
 struct CXMLWriter::SImplementation {
     std::shared_ptr<CDataSink> DDataSink; // Data sink for writing XML
-    std::vector<std::string> DElementStack; // Stack to track open elements
-    std::ostringstream DBuffer; // Buffer to accumulate XML data
+    std::string DElementNames; // Names of the open elements back to back
+    std::vector<std::size_t> DElementStarts; // Where each open element's name starts in DElementNames
+    std::vector<char> DBuffer; // Buffer to accumulate XML data, reused between writes
+    bool DTagOpen; // A start tag from StartElement still takes attributes
 
     // Constructor: Initializes the data sink
     SImplementation(std::shared_ptr<CDataSink> sink)
-        : DDataSink(std::move(sink)) {}
+        : DDataSink(std::move(sink)), DTagOpen(false) {}
 
     // Flush the buffer to the data sink
-    void FlushBuffer() {
-        std::string data = DBuffer.str(); // Get buffer content
-        if (!data.empty()) {
-            // Convert std::string to std::vector<char>
-            std::vector<char> buffer(data.begin(), data.end());
-            DDataSink->Write(buffer); // Write to sink
-            DBuffer.str(""); // Clear the buffer
-            DBuffer.clear();
+    bool FlushBuffer() {
+        bool success = true;
+        if (!DBuffer.empty()) {
+            success = DDataSink->Write(DBuffer); // Write to sink
+            DBuffer.clear(); // Keeps its capacity for the next write
         }
+        return success;
+    }
+
+    void Append(std::string_view str) {
+        DBuffer.insert(DBuffer.end(), str.begin(), str.end());
     }
 
-    // Escape special XML characters in a string
-    std::string EscapeXML(const std::string &input) {
-        std::string output;
-        for (char c : input) {
-            switch (c) {
-                case '&': output += "&amp;"; break;
-                case '<': output += "&lt;"; break;
-                case '>': output += "&gt;"; break;
-                case '"': output += "&quot;"; break;
-                case '\'': output += "&apos;"; break;
-                default: output += c; break;
+    // Append a string escaping special XML characters, runs of ordinary
+    // characters are copied in one step
+    void AppendEscaped(std::string_view input) {
+        std::size_t start = 0;
+        for (std::size_t index = 0; index < input.size(); index++) {
+            const char *replacement;
+            switch (input[index]) {
+                case '&': replacement = "&amp;"; break;
+                case '<': replacement = "&lt;"; break;
+                case '>': replacement = "&gt;"; break;
+                case '"': replacement = "&quot;"; break;
+                case '\'': replacement = "&apos;"; break;
+                default: continue;
             }
+            Append(input.substr(start, index - start));
+            Append(replacement);
+            start = index + 1;
         }
-        return output;
+        Append(input.substr(start));
+    }
+
+    void AppendAttribute(std::string_view name, std::string_view value) {
+        DBuffer.push_back(' ');
+        Append(name);
+        Append("=\"");
+        AppendEscaped(value);
+        DBuffer.push_back('"');
+    }
+
+    // Finish a start tag left open by StartElement
+    void CloseTag() {
+        if (DTagOpen) {
+            DBuffer.push_back('>');
+            DTagOpen = false;
+        }
+    }
+
+    void PushElement(std::string_view name) {
+        DElementStarts.push_back(DElementNames.size());
+        DElementNames.append(name);
+    }
+
+    void PopElement() {
+        DElementNames.resize(DElementStarts.back());
+        DElementStarts.pop_back();
+    }
+
+    std::string_view TopElement() const {
+        return std::string_view(DElementNames).substr(DElementStarts.back());
     }
 
     // Write a start element (e.g., <element>)
     void WriteStartElement(const std::string &name, const std::vector<SXMLEntity::TAttribute> &attrs) {
-        DBuffer << "<" << name; // Write element name
+        CloseTag();
+        DBuffer.push_back('<');
+        Append(name); // Write element name
         // Write attributes
         for (const auto &attr : attrs) {
-            DBuffer << " " << attr.first << "=\"" << EscapeXML(attr.second) << "\"";
+            AppendAttribute(attr.first, attr.second);
         }
-        DBuffer << ">"; // Close the start tag
-        FlushBuffer(); // Flush the buffer
+        DBuffer.push_back('>'); // Close the start tag
     }
 
     // Write an end element (e.g., </element>)
-    void WriteEndElement(const std::string &name) {
-        DBuffer << "</" << name << ">"; // Write end tag
-        FlushBuffer(); // Flush the buffer
+    void WriteEndElement(std::string_view name) {
+        CloseTag();
+        Append("</");
+        Append(name);
+        DBuffer.push_back('>'); // Write end tag
     }
 
     // Write a complete element (e.g., <element />)
     void WriteCompleteElement(const std::string &name, const std::vector<SXMLEntity::TAttribute> &attrs) {
-        DBuffer << "<" << name; // Write element name
+        CloseTag();
+        DBuffer.push_back('<');
+        Append(name); // Write element name
         // Write attributes
         for (const auto &attr : attrs) {
-            DBuffer << " " << attr.first << "=\"" << EscapeXML(attr.second) << "\"";
+            AppendAttribute(attr.first, attr.second);
         }
-        DBuffer << "/>"; // Close the self-closing tag
-        FlushBuffer(); // Flush the buffer
+        Append("/>"); // Close the self-closing tag
     }
 
     // Write character data (e.g., text content)
-    void WriteString(const std::string &str) {
-        DBuffer << EscapeXML(str); // Write escaped string
-        FlushBuffer(); // Flush the buffer
+    void WriteString(std::string_view str) {
+        CloseTag();
+        AppendEscaped(str); // Write escaped string
+    }
+
+    // Hand finished output to the sink, held back while a start tag can
+    // still take attributes so the sink never sees half a tag
+    bool Written() {
+        return DTagOpen || FlushBuffer();
     }
 };
 
@@ -89,13 +135,13 @@ CXMLWriter::~CXMLWriter() {
 
 // Flush all open elements by writing their end tags
 bool CXMLWriter::Flush() {
-    while (!DImplementation->DElementStack.empty()) {
-        std::string name = DImplementation->DElementStack.back();
-        DImplementation->DElementStack.pop_back();
-        DImplementation->DBuffer << "</" << name << ">"; // Write end tag
+    DImplementation->CloseTag();
+    while (!DImplementation->DElementStarts.empty()) {
+        DImplementation->WriteEndElement(DImplementation->TopElement()); // Write end tag
+        DImplementation->PopElement();
     }
-    DImplementation->FlushBuffer(); // Flush the buffer
-    return true;
+    bool success = DImplementation->FlushBuffer(); // Flush the buffer
+    return DImplementation->DDataSink->Flush() && success; // Let buffering sinks report errors
 }
 
 // Write an XML entity to the output
@@ -103,11 +149,11 @@ bool CXMLWriter::WriteEntity(const SXMLEntity &entity) {
     switch (entity.DType) {
         case SXMLEntity::EType::StartElement:
             DImplementation->WriteStartElement(entity.DNameData, entity.DAttributes);
-            DImplementation->DElementStack.push_back(entity.DNameData); // Track open element
+            DImplementation->PushElement(entity.DNameData); // Track open element
             break;
         case SXMLEntity::EType::EndElement:
-            if (!DImplementation->DElementStack.empty() && DImplementation->DElementStack.back() == entity.DNameData) {
-                DImplementation->DElementStack.pop_back(); // Remove from stack
+            if (!DImplementation->DElementStarts.empty() && DImplementation->TopElement() == entity.DNameData) {
+                DImplementation->PopElement(); // Remove from stack
             }
             DImplementation->WriteEndElement(entity.DNameData);
             break;
@@ -120,8 +166,52 @@ bool CXMLWriter::WriteEntity(const SXMLEntity &entity) {
         default:
             return false; // Invalid entity type
     }
+    DImplementation->FlushBuffer(); // Flush the buffer
+    return true;
+}
+
+// Open an element without building an SXMLEntity, the start tag stays open
+// for Attribute calls until the next element, text or end
+bool CXMLWriter::StartElement(std::string_view name) {
+    DImplementation->CloseTag();
+    DImplementation->DBuffer.push_back('<');
+    DImplementation->Append(name);
+    DImplementation->PushElement(name);
+    DImplementation->DTagOpen = true;
+    return true;
+}
+
+// Add an attribute to the start tag just opened, false once it is closed
+bool CXMLWriter::Attribute(std::string_view name, std::string_view value) {
+    if (!DImplementation->DTagOpen) {
+        return false;
+    }
+    DImplementation->AppendAttribute(name, value);
     return true;
 }
+
+// Write escaped character data inside the current element
+bool CXMLWriter::Text(std::string_view text) {
+    DImplementation->WriteString(text);
+    return DImplementation->Written();
+}
+
+// Close the most recently opened element, an element with nothing written
+// inside it is closed as <name/>
+bool CXMLWriter::EndElement() {
+    if (DImplementation->DElementStarts.empty()) {
+        return false;
+    }
+    if (DImplementation->DTagOpen) {
+        DImplementation->Append("/>");
+        DImplementation->DTagOpen = false;
+    }
+    else {
+        DImplementation->WriteEndElement(DImplementation->TopElement());
+    }
+    DImplementation->PopElement();
+    return DImplementation->Written();
+}
 // struct CXMLWriter::SImplementation {
 // };
 
@@ -0,0 +1,126 @@
+#include "gtest/gtest.h"
+#include "BinarySpill.h"
+#include "StringDataSource.h"
+#include "StringDataSink.h"
+#include <vector>
+#include <string>
+
+namespace{
+
+SXMLEntity MakeEntity(SXMLEntity::EType type, const std::string &name, std::vector<SXMLEntity::TAttribute> attributes = {}){
+    SXMLEntity Entity;
+    Entity.DType = type;
+    Entity.DNameData = name;
+    Entity.DAttributes = std::move(attributes);
+    return Entity;
+}
+
+void ExpectSameEntity(const SXMLEntity &actual, const SXMLEntity &expected){
+    EXPECT_EQ(actual.DType, expected.DType);
+    EXPECT_EQ(actual.DNameData, expected.DNameData);
+    EXPECT_EQ(actual.DAttributes, expected.DAttributes);
+}
+
+}
+
+// entities and rows come back exactly as written, in order
+TEST(BinarySpillTest, RoundTrip) {
+    std::vector<SXMLEntity> entities = {
+        MakeEntity(SXMLEntity::EType::StartElement, "record", {{"id", "1"}, {"note", std::string("a\0b<&>", 6)}}),
+        MakeEntity(SXMLEntity::EType::CharData, "text with \"quotes\", commas\nand newlines"),
+        MakeEntity(SXMLEntity::EType::CompleteElement, "empty", {{"id", ""}}),
+        MakeEntity(SXMLEntity::EType::EndElement, "record")
+    };
+    std::vector<std::string> row = {"a", "", std::string(300, 'x'), "d,e"};
+
+    for(bool dictionary : {true, false}){
+        auto Sink = std::make_shared<CStringDataSink>();
+        CBinarySpillWriter writer(Sink, dictionary);
+        for(auto &Entity : entities){
+            EXPECT_TRUE(writer.WriteEntity(Entity));
+        }
+        EXPECT_TRUE(writer.WriteRow(row));
+        EXPECT_TRUE(writer.WriteEntity(entities[0]));
+        EXPECT_TRUE(writer.Flush());
+
+        CBinarySpillReader reader(std::make_shared<CStringDataSource>(Sink->String()));
+        SXMLEntity entity;
+        for(auto &Expected : entities){
+            ASSERT_EQ(reader.Next(), ESpillRecord::Entity);
+            ASSERT_TRUE(reader.ReadEntity(entity));
+            ExpectSameEntity(entity, Expected);
+        }
+        EXPECT_FALSE(reader.ReadEntity(entity));
+        std::vector<std::string> readRow = {"old", "values", "to", "reuse", "extra"};
+        ASSERT_TRUE(reader.ReadRow(readRow));
+        EXPECT_EQ(readRow, row);
+        ASSERT_TRUE(reader.ReadEntity(entity));
+        ExpectSameEntity(entity, entities[0]);
+        EXPECT_EQ(reader.Next(), ESpillRecord::End);
+        EXPECT_TRUE(reader.End());
+    }
+}
+
+// repeated names are written once with the dictionary on
+TEST(BinarySpillTest, DictionaryShrinksOutput) {
+    auto WithNames = std::make_shared<CStringDataSink>();
+    auto Plain = std::make_shared<CStringDataSink>();
+    {
+        CBinarySpillWriter dictionaryWriter(WithNames, true);
+        CBinarySpillWriter plainWriter(Plain, false);
+        for(int Index = 0; Index < 100; Index++){
+            SXMLEntity Entity = MakeEntity(SXMLEntity::EType::StartElement, "a_fairly_long_element_name", {{"attribute_name", std::to_string(Index)}});
+            dictionaryWriter.WriteEntity(Entity);
+            plainWriter.WriteEntity(Entity);
+        }
+    }
+    EXPECT_LT(WithNames->String().size() * 4, Plain->String().size());
+
+    CBinarySpillReader reader(std::make_shared<CStringDataSource>(WithNames->String()));
+    SXMLEntity entity;
+    int Count = 0;
+    while(reader.ReadEntity(entity)){
+        EXPECT_EQ(entity.DNameData, "a_fairly_long_element_name");
+        EXPECT_EQ(entity.AttributeValue("attribute_name"), std::to_string(Count));
+        Count++;
+    }
+    EXPECT_EQ(Count, 100);
+    EXPECT_EQ(reader.Next(), ESpillRecord::End);
+}
+
+// streams too large for one block are read across refills
+TEST(BinarySpillTest, ManyRows) {
+    auto Sink = std::make_shared<CStringDataSink>();
+    CBinarySpillWriter writer(Sink);
+    for(int Index = 0; Index < 20000; Index++){
+        writer.WriteRow({std::to_string(Index), "value"});
+    }
+    writer.WriteRow({std::string(200000, 'y')});
+    writer.Flush();
+
+    CBinarySpillReader reader(std::make_shared<CStringDataSource>(Sink->String()));
+    std::vector<std::string> row;
+    for(int Index = 0; Index < 20000; Index++){
+        ASSERT_TRUE(reader.ReadRow(row));
+        ASSERT_EQ(row[0], std::to_string(Index));
+    }
+    ASSERT_TRUE(reader.ReadRow(row));
+    EXPECT_EQ(row[0].size(), 200000);
+    EXPECT_TRUE(reader.End());
+}
+
+// bad input is reported instead of misread
+TEST(BinarySpillTest, CorruptInput) {
+    CBinarySpillReader notSpill(std::make_shared<CStringDataSource>("a,b\nc,d\n"));
+    EXPECT_EQ(notSpill.Next(), ESpillRecord::Error);
+
+    auto Sink = std::make_shared<CStringDataSink>();
+    CBinarySpillWriter writer(Sink);
+    writer.WriteRow({"abcdef", "ghijkl"});
+    writer.Flush();
+    std::string Truncated = Sink->String().substr(0, Sink->String().size() - 3);
+    CBinarySpillReader reader(std::make_shared<CStringDataSource>(Truncated));
+    std::vector<std::string> row;
+    EXPECT_FALSE(reader.ReadRow(row));
+    EXPECT_EQ(reader.Next(), ESpillRecord::Error);
+}
@@ -0,0 +1,226 @@
+#include <gtest/gtest.h>
+#include "CompressedDataSource.h"
+#include "CompressedDataSink.h"
+#include "StringDataSource.h"
+#include "StringDataSink.h"
+#include "DSVReader.h"
+#include "DSVWriter.h"
+#include <zlib.h>
+
+namespace{
+
+std::string MakeText(std::size_t lines){
+    std::string Text;
+    for(std::size_t Index = 0; Index < lines; Index++){
+        Text += "row " + std::to_string(Index) + ",value " + std::to_string(Index * 7) + "\n";
+    }
+    return Text;
+}
+
+std::string Compress(const std::string &text, ECompressionFormat format, bool background){
+    auto Sink = std::make_shared<CStringDataSink>();
+    CCompressedDataSink Compressor(Sink, format, 6, background);
+    std::vector<char> Buffer(text.begin(), text.end());
+    EXPECT_TRUE(Compressor.Write(Buffer));
+    EXPECT_TRUE(Compressor.Flush());
+    return Sink->String();
+}
+
+// Source handing out one byte per read
+class COneByteSource : public CDataSource{
+    private:
+        std::string DData;
+        std::size_t DIndex = 0;
+
+    public:
+        COneByteSource(std::string data) : DData(std::move(data)){
+
+        }
+
+        bool End() const noexcept override{
+            return DIndex >= DData.size();
+        }
+
+        bool Get(char &ch) noexcept override{
+            if(End()){
+                return false;
+            }
+            ch = DData[DIndex++];
+            return true;
+        }
+
+        bool Peek(char &ch) noexcept override{
+            if(End()){
+                return false;
+            }
+            ch = DData[DIndex];
+            return true;
+        }
+
+        bool Read(std::vector<char> &buf, std::size_t count) noexcept override{
+            buf.clear();
+            char Ch;
+            if(count && Get(Ch)){
+                buf.push_back(Ch);
+            }
+            return !buf.empty();
+        }
+};
+
+std::string Decompress(std::shared_ptr< CDataSource > input, ECompressionFormat expected){
+    auto Source = std::make_shared<CCompressedDataSource>(std::move(input));
+    EXPECT_EQ(Source->Format(), expected);
+    std::string Result;
+    std::vector<char> Buffer;
+    while(Source->Read(Buffer, 1000)){
+        Result.append(Buffer.data(), Buffer.size());
+    }
+    EXPECT_TRUE(Source->End());
+    EXPECT_FALSE(Source->Error());
+    return Result;
+}
+
+std::string Decompress(const std::string &data, ECompressionFormat expected){
+    return Decompress(std::make_shared<CStringDataSource>(data), expected);
+}
+
+}
+
+TEST(CompressedDataSource, PassThrough){
+    CCompressedDataSource Source(std::make_shared<CStringDataSource>("Hello"));
+    char TempCh = 'x';
+
+    EXPECT_EQ(Source.Format(), ECompressionFormat::None);
+    EXPECT_FALSE(Source.End());
+    EXPECT_TRUE(Source.Peek(TempCh));
+    EXPECT_EQ(TempCh, 'H');
+    EXPECT_TRUE(Source.Get(TempCh));
+    EXPECT_EQ(TempCh, 'H');
+    EXPECT_EQ(Decompress("Hello", ECompressionFormat::None), "Hello");
+
+    CCompressedDataSource EmptySource(std::make_shared<CStringDataSource>(""));
+    EXPECT_TRUE(EmptySource.End());
+    EXPECT_FALSE(EmptySource.Get(TempCh));
+}
+
+TEST(CompressedDataSource, ZlibCompatible){
+    std::string Text = MakeText(5000);
+    std::vector<char> Packed(compressBound(Text.size()));
+    uLongf PackedLength = Packed.size();
+    ASSERT_EQ(compress(reinterpret_cast<Bytef *>(Packed.data()), &PackedLength, reinterpret_cast<const Bytef *>(Text.data()), Text.size()), Z_OK);
+
+    EXPECT_EQ(Decompress(std::string(Packed.data(), PackedLength), ECompressionFormat::Zlib), Text);
+}
+
+// text whose first two bytes happen to form a valid zlib header
+TEST(CompressedDataSource, TextLikeZlibHeader){
+    for(std::string Text : {"80,apples\n", "H,1\n", "x y\n", "x^2,3\n"}){
+        EXPECT_EQ(Decompress(Text, ECompressionFormat::None), Text);
+    }
+}
+
+// the magic bytes are gathered across reads before the format is picked
+TEST(CompressedDataSource, ShortReadDetection){
+    std::string Text = MakeText(200);
+
+    EXPECT_EQ(Decompress(std::make_shared<COneByteSource>(Compress(Text, ECompressionFormat::Gzip, false)), ECompressionFormat::Gzip), Text);
+    EXPECT_EQ(Decompress(std::make_shared<COneByteSource>(Compress(Text, ECompressionFormat::Zlib, false)), ECompressionFormat::Zlib), Text);
+    EXPECT_EQ(Decompress(std::make_shared<COneByteSource>(Text), ECompressionFormat::None), Text);
+    EXPECT_EQ(Decompress(std::make_shared<COneByteSource>("x^2,3\n"), ECompressionFormat::None), "x^2,3\n");
+
+    CCompressedDataSource Zstd(std::make_shared<COneByteSource>(std::string("\x28\xB5\x2F\xFD\x00\x00", 6)));
+    EXPECT_EQ(Zstd.Format(), ECompressionFormat::Zstd);
+}
+
+TEST(CompressedDataSink, GzipRoundTrip){
+    std::string Text = MakeText(20000);
+    std::string Packed = Compress(Text, ECompressionFormat::Gzip, false);
+
+    EXPECT_LT(Packed.size(), Text.size());
+    EXPECT_EQ(Decompress(Packed, ECompressionFormat::Gzip), Text);
+}
+
+TEST(CompressedDataSink, BackgroundRoundTrip){
+    std::string Text = MakeText(20000);
+
+    EXPECT_EQ(Compress(Text, ECompressionFormat::Gzip, true), Compress(Text, ECompressionFormat::Gzip, false));
+    EXPECT_EQ(Decompress(Compress(Text, ECompressionFormat::Zlib, true), ECompressionFormat::Zlib), Text);
+}
+
+TEST(CompressedDataSink, MultipleMembers){
+    auto Sink = std::make_shared<CStringDataSink>();
+    {
+        CCompressedDataSink Compressor(Sink);
+        EXPECT_TRUE(Compressor.Write(std::vector<char>{'a', 'b'}));
+        EXPECT_TRUE(Compressor.Flush());
+        EXPECT_TRUE(Compressor.Put('c'));
+    }
+
+    EXPECT_EQ(Decompress(Sink->String(), ECompressionFormat::Gzip), "abc");
+}
+
+TEST(CompressedDataSink, ZlibFlushBetweenWrites){
+    auto Sink = std::make_shared<CStringDataSink>();
+    {
+        CCompressedDataSink Compressor(Sink, ECompressionFormat::Zlib);
+        EXPECT_TRUE(Compressor.Write(std::vector<char>{'h', 'e', 'l', 'l', 'o'}));
+        EXPECT_TRUE(Compressor.Flush());
+        EXPECT_TRUE(Compressor.Write(std::vector<char>{' ', 'w', 'o', 'r', 'l', 'd'}));
+        EXPECT_TRUE(Compressor.Flush());
+    }
+
+    EXPECT_EQ(Decompress(Sink->String(), ECompressionFormat::Zlib), "hello world");
+}
+
+// bytes after the last stream that do not form another stream are an error
+TEST(CompressedDataSource, TrailingGarbage){
+    for(auto Format : {ECompressionFormat::Gzip, ECompressionFormat::Zlib}){
+        CCompressedDataSource Source(std::make_shared<CStringDataSource>(Compress("abc", Format, false) + "junk"));
+        std::string Result;
+        std::vector<char> Buffer;
+        while(Source.Read(Buffer, 1000)){
+            Result.append(Buffer.data(), Buffer.size());
+        }
+        EXPECT_EQ(Result, "abc");
+        EXPECT_TRUE(Source.Error());
+    }
+}
+
+TEST(CompressedDataSink, DSVRoundTrip){
+    auto Sink = std::make_shared<CStringDataSink>();
+    auto Compressor = std::make_shared<CCompressedDataSink>(Sink, ECompressionFormat::Gzip, 6, true);
+    {
+        CDSVWriter Writer(Compressor, ',');
+        for(int Index = 0; Index < 1000; Index++){
+            EXPECT_TRUE(Writer.WriteRow({std::to_string(Index), "a,b", "c"}));
+        }
+    }
+    EXPECT_TRUE(Compressor->Flush());
+
+    CDSVReader Reader(std::make_shared<CCompressedDataSource>(std::make_shared<CStringDataSource>(Sink->String())), ',');
+    std::vector<std::string> Row;
+    for(int Index = 0; Index < 1000; Index++){
+        ASSERT_TRUE(Reader.ReadRow(Row));
+        EXPECT_EQ(Row, (std::vector<std::string>{std::to_string(Index), "a,b", "c"}));
+    }
+    EXPECT_TRUE(Reader.End());
+}
+
+TEST(CompressedDataSource, Truncated){
+    std::string Packed = Compress(MakeText(1000), ECompressionFormat::Gzip, false);
+    CCompressedDataSource Source(std::make_shared<CStringDataSource>(Packed.substr(0, Packed.size() / 2)));
+    std::vector<char> Buffer;
+
+    while(Source.Read(Buffer, 4096)){
+    }
+    EXPECT_TRUE(Source.End());
+    EXPECT_TRUE(Source.Error());
+}
+
+TEST(CompressedDataSource, ZstdDetected){
+    CCompressedDataSource Source(std::make_shared<CStringDataSource>(std::string("\x28\xB5\x2F\xFD\x00\x00", 6)));
+
+    EXPECT_EQ(Source.Format(), ECompressionFormat::Zstd);
+    EXPECT_TRUE(Source.End());
+    EXPECT_TRUE(Source.Error());
+}
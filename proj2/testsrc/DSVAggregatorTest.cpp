@@ -0,0 +1,116 @@
+#include "gtest/gtest.h"
+#include "DSVAggregator.h"
+#include "DSVReader.h"
+#include "StringDataSource.h"
+#include "StringDataSink.h"
+#include <map>
+
+namespace{
+
+std::vector<std::vector<std::string>> ReadAll(const std::string &data){
+    CDSVReader Reader(std::make_shared<CStringDataSource>(data), ',');
+    std::vector<std::vector<std::string>> Rows;
+    std::vector<std::string> Row;
+    while(Reader.ReadRow(Row)){
+        Rows.push_back(Row);
+    }
+    return Rows;
+}
+
+}
+
+TEST(DSVAggregatorTest, GroupBy){
+    std::string Input = "city,kind,amount,price\n"
+                        "\"Davis, CA\",a,3,1.5\n"
+                        "Sacramento,b,4,2\n"
+                        "\"Davis, CA\",b,x,0.25\n"
+                        "Sacramento,b,-10,\n"
+                        "Napa,a,,\n";
+    CDSVAggregator Aggregator({0}, {
+        SDSVAggregate{EDSVAggregateFunction::Count},
+        SDSVAggregate{EDSVAggregateFunction::Sum, 2, EDSVAggregateType::Integer},
+        SDSVAggregate{EDSVAggregateFunction::Min, 2, EDSVAggregateType::Integer},
+        SDSVAggregate{EDSVAggregateFunction::Max, 3, EDSVAggregateType::Double},
+        SDSVAggregate{EDSVAggregateFunction::Mean, 3, EDSVAggregateType::Double}
+    });
+    EXPECT_TRUE(Aggregator.Consume(std::make_shared<CStringDataSource>(Input), ',', true));
+    EXPECT_EQ(Aggregator.GroupCount(), 3);
+
+    auto Sink = std::make_shared<CStringDataSink>();
+    CDSVWriter Writer(Sink, ',');
+    EXPECT_TRUE(Aggregator.Write(Writer));
+    EXPECT_EQ(Sink->String(), "\"Davis, CA\",2,3,3,1.5,0.875\nSacramento,2,-6,-10,2,2\nNapa,1,0,,,\n");
+}
+
+// several key columns, and the partitioned mode gives the same result
+TEST(DSVAggregatorTest, Partitioned){
+    std::string Input;
+    std::map<std::pair<int, int>, std::pair<long, long>> Expected;
+    for(int Index = 0; Index < 50000; Index++){
+        int First = (Index * 7) % 113;
+        int Second = Index % 3;
+        Input += std::to_string(First) + "," + std::to_string(Second) + "," + std::to_string(Index) + "\n";
+        Expected[{First, Second}].first++;
+        Expected[{First, Second}].second += Index;
+    }
+    std::vector<SDSVAggregate> Aggregates = {
+        SDSVAggregate{EDSVAggregateFunction::Count},
+        SDSVAggregate{EDSVAggregateFunction::Sum, 2, EDSVAggregateType::Integer}
+    };
+    CDSVAggregator Serial({0, 1}, Aggregates);
+    CDSVAggregator Parallel({0, 1}, Aggregates, 4);
+    EXPECT_TRUE(Serial.Consume(std::make_shared<CStringDataSource>(Input), ','));
+    EXPECT_TRUE(Parallel.Consume(std::make_shared<CStringDataSource>(Input), ','));
+    EXPECT_EQ(Parallel.GroupCount(), Expected.size());
+
+    auto SerialSink = std::make_shared<CStringDataSink>();
+    auto ParallelSink = std::make_shared<CStringDataSink>();
+    CDSVWriter SerialWriter(SerialSink, ',');
+    CDSVWriter ParallelWriter(ParallelSink, ',');
+    EXPECT_TRUE(Serial.Write(SerialWriter));
+    EXPECT_TRUE(Parallel.Write(ParallelWriter));
+    EXPECT_EQ(SerialSink->String(), ParallelSink->String());
+
+    auto Rows = ReadAll(ParallelSink->String());
+    ASSERT_EQ(Rows.size(), Expected.size());
+    for(auto &Row : Rows){
+        auto &Totals = Expected[{std::stoi(Row[0]), std::stoi(Row[1])}];
+        EXPECT_EQ(std::stol(Row[2]), Totals.first);
+        EXPECT_EQ(std::stol(Row[3]), Totals.second);
+    }
+
+    // a second source adds to the same groups
+    EXPECT_TRUE(Parallel.Consume(std::make_shared<CStringDataSource>("0,0,5\n"), ','));
+    EXPECT_EQ(Parallel.GroupCount(), Expected.size());
+}
+
+// integer totals past the range of int64 are reported rather than wrapped
+TEST(DSVAggregatorTest, IntegerOverflow){
+    std::string Input = "a,9223372036854775806\n"
+                        "b,-9223372036854775807\n"
+                        "c,9223372036854775807\n"
+                        "a,1\n"
+                        "b,-1\n"
+                        "c,1\n"
+                        "c,-5\n";
+    for(std::size_t Threads : {1, 2}){
+        CDSVAggregator Aggregator({0}, {
+            SDSVAggregate{EDSVAggregateFunction::Sum, 1, EDSVAggregateType::Integer},
+            SDSVAggregate{EDSVAggregateFunction::Max, 1, EDSVAggregateType::Integer},
+            SDSVAggregate{EDSVAggregateFunction::Mean, 1, EDSVAggregateType::Integer}
+        }, Threads);
+        EXPECT_FALSE(Aggregator.Consume(std::make_shared<CStringDataSource>(Input), ','));
+
+        auto Sink = std::make_shared<CStringDataSink>();
+        CDSVWriter Writer(Sink, ',');
+        EXPECT_TRUE(Aggregator.Write(Writer));
+        EXPECT_EQ(ReadAll(Sink->String()), (std::vector<std::vector<std::string>>{
+            {"a", "9223372036854775807", "9223372036854775806", "4611686018427387904"},
+            {"b", "-9223372036854775808", "-1", "-4611686018427387904"},
+            {"c", "", "9223372036854775807"}
+        }));
+    }
+
+    CDSVAggregator InRange({0}, {SDSVAggregate{EDSVAggregateFunction::Sum, 1, EDSVAggregateType::Integer}});
+    EXPECT_TRUE(InRange.Consume(std::make_shared<CStringDataSource>(std::string("a,9223372036854775807\na,-1\n")), ','));
+}
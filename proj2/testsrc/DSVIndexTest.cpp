@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include "DSVIndex.h"
+#include "StringDataSource.h"
+#include "StringDataSink.h"
+
+namespace{
+
+std::string MakeData(std::size_t rows){
+    std::string Data;
+    for(std::size_t Index = 0; Index < rows; Index++){
+        Data += std::to_string(Index) + ",\"multi\nline " + std::to_string(Index) + "\",\"\"\"q\"\"\"\n";
+    }
+    return Data;
+}
+
+std::vector<std::string> ExpectedRow(std::size_t index){
+    return {std::to_string(index), "multi\nline " + std::to_string(index), "\"q\""};
+}
+
+}
+
+TEST(DSVIndex, BuildTest){
+    CStringDataSource Source(MakeData(100));
+    CDSVIndex Index(16);
+
+    EXPECT_TRUE(Index.Build(Source));
+    EXPECT_EQ(Index.RowCount(), 100);
+    EXPECT_EQ(Index.Stride(), 16);
+    EXPECT_EQ(Index.Offset(0), 0);
+    EXPECT_EQ(Index.Offset(15), 0);
+    EXPECT_EQ(Index.Offset(16), MakeData(16).size());
+    EXPECT_EQ(Index.Offset(99), MakeData(96).size());
+}
+
+TEST(DSVIndex, NoTrailingNewline){
+    CStringDataSource Source("a\n\nb");
+    CDSVIndex Index(1);
+
+    EXPECT_TRUE(Index.Build(Source));
+    EXPECT_EQ(Index.RowCount(), 3);
+    EXPECT_EQ(Index.Offset(1), 2);
+    EXPECT_EQ(Index.Offset(2), 3);
+}
+
+TEST(DSVIndex, OpenAtTest){
+    std::string Data = MakeData(100);
+    auto Source = std::make_shared<CStringDataSource>(Data);
+    CDSVIndex Index(16);
+    ASSERT_TRUE(Index.Build(*Source));
+
+    for(std::size_t Row : {0, 1, 16, 37, 96, 99}){
+        auto Reader = Index.OpenAt(Source, ',', Row);
+        ASSERT_TRUE(Reader);
+        std::vector<std::string> Values;
+        ASSERT_TRUE(Reader->ReadRow(Values));
+        EXPECT_EQ(Values, ExpectedRow(Row));
+    }
+    EXPECT_FALSE(Index.OpenAt(Source, ',', 100));
+}
+
+TEST(DSVIndex, SaveLoadTest){
+    CStringDataSource Source(MakeData(50));
+    CDSVIndex Index(7);
+    ASSERT_TRUE(Index.Build(Source));
+    CStringDataSink Sidecar;
+    EXPECT_TRUE(Index.Save(Sidecar));
+
+    CDSVIndex Loaded;
+    CStringDataSource SidecarSource(Sidecar.String());
+    EXPECT_TRUE(Loaded.Load(SidecarSource));
+    EXPECT_EQ(Loaded.Stride(), 7);
+    EXPECT_EQ(Loaded.RowCount(), 50);
+    for(std::size_t Row = 0; Row < 50; Row++){
+        EXPECT_EQ(Loaded.Offset(Row), Index.Offset(Row));
+    }
+
+    CStringDataSource BadSource("not an index\n");
+    EXPECT_FALSE(Loaded.Load(BadSource));
+    EXPECT_EQ(Loaded.RowCount(), 50);
+}
+
+// rows are found by the reader's own scanner, so a BOM, CRLF line ends and
+// rows dropped by the error policy index and reopen consistently
+TEST(DSVIndex, ReadOptions){
+    std::string Data = "\xEF\xBB\xBFid,text\r\n";
+    for(std::size_t Index = 0; Index < 40; Index++){
+        Data += std::to_string(Index) + (Index % 7 == 3 ? ",bad\"quote\"x\r\n" : ",\"two\r\nlines\"\r\n");
+    }
+    for(auto Policy : {EDSVErrorPolicy::Lenient, EDSVErrorPolicy::SkipRow, EDSVErrorPolicy::Fail}){
+        SDSVReadOptions Options;
+        Options.DStripCR = true;
+        Options.DSkipBOM = true;
+        Options.DErrorPolicy = Policy;
+
+        std::vector<std::vector<std::string>> Expected;
+        CDSVReader Sequential(std::make_shared<CStringDataSource>(Data), ',', Options);
+        std::vector<std::string> Values;
+        while(!Sequential.End()){
+            if(Sequential.ReadRow(Values)){
+                Expected.push_back(Values);
+            }
+        }
+
+        auto Source = std::make_shared<CStringDataSource>(Data);
+        CDSVIndex Index(4);
+        ASSERT_TRUE(Index.Build(*Source, ',', Options));
+        ASSERT_EQ(Index.RowCount(), Expected.size());
+        EXPECT_EQ(Expected[0], std::vector<std::string>({"id", "text"}));
+        for(std::size_t Row = 0; Row < Expected.size(); Row++){
+            auto Reader = Index.OpenAt(Source, ',', Row, Options);
+            ASSERT_TRUE(Reader);
+            // under Fail a dropped row just before is reported first
+            bool Read = Reader->ReadRow(Values) || (Policy == EDSVErrorPolicy::Fail && Reader->ReadRow(Values));
+            ASSERT_TRUE(Read);
+            EXPECT_EQ(Values, Expected[Row]);
+        }
+    }
+}
+
+// counts in the sidecar must be plain unsigned decimals
+TEST(DSVIndex, LoadRejectsMalformedCounts){
+    CDSVIndex Index;
+    for(std::string Text : {"DSVINDEX1 2 3\n0\n-1\n", "DSVINDEX1 2 3\n0\n+5\n", "DSVINDEX1 2 3\n0\n5x\n", "DSVINDEX1 2 3\n0\n\n",
+                            "DSVINDEX1 -2 3\n0\n5\n", "DSVINDEX1 2 3 junk\n0\n5\n", "DSVINDEX1 2  3\n0\n5\n", "DSVINDEX1 2 3\n0\n 5\n"}){
+        CStringDataSource Source(Text);
+        EXPECT_FALSE(Index.Load(Source)) << Text;
+    }
+    CStringDataSource Source("DSVINDEX1 2 3\n0\n5\n");
+    EXPECT_TRUE(Index.Load(Source));
+    EXPECT_EQ(Index.Offset(2), 5);
+}
+
+TEST(DSVIndex, UnseekableSource){
+    // a source without Seek support cannot be opened at a row
+    class CForwardOnlySource : public CStringDataSource{
+        public:
+            CForwardOnlySource(const std::string &str) : CStringDataSource(str){}
+            bool Seek(std::size_t) noexcept override{ return false; }
+    };
+    auto Source = std::make_shared<CForwardOnlySource>(MakeData(10));
+    CDSVIndex Index(4);
+    ASSERT_TRUE(Index.Build(*Source));
+
+    EXPECT_FALSE(Index.OpenAt(Source, ',', 5));
+}
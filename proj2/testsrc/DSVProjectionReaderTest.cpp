@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include "DSVProjectionReader.h"
+#include "StringDataSource.h"
+
+TEST(DSVProjectionReader, ProjectByIndex){
+    std::string Data = "a,1,skip \"me\",2.5\nb,x,\"skip,\nme\",3\n";
+    std::vector< SDSVColumn > Columns(3);
+    Columns[0].DIndex = 3;
+    Columns[0].DType = EDSVColumnType::Double;
+    Columns[1].DIndex = 0;
+    Columns[1].DType = EDSVColumnType::String;
+    Columns[2].DIndex = 1;
+    Columns[2].DType = EDSVColumnType::Integer;
+    CDSVProjectionReader Reader(std::make_shared<CStringDataSource>(Data), ',', Columns);
+    std::vector< SDSVValue > Values;
+
+    ASSERT_TRUE(Reader.Valid());
+    ASSERT_TRUE(Reader.ReadRow(Values));
+    ASSERT_EQ(Values.size(), 3);
+    EXPECT_TRUE(Values[0].DValid);
+    EXPECT_DOUBLE_EQ(Values[0].DDouble, 2.5);
+    EXPECT_EQ(Values[1].DString, "a");
+    EXPECT_TRUE(Values[2].DValid);
+    EXPECT_EQ(Values[2].DInteger, 1);
+
+    ASSERT_TRUE(Reader.ReadRow(Values));
+    EXPECT_DOUBLE_EQ(Values[0].DDouble, 3.0);
+    EXPECT_EQ(Values[1].DString, "b");
+    EXPECT_FALSE(Values[2].DValid);
+
+    EXPECT_TRUE(Reader.End());
+    EXPECT_FALSE(Reader.ReadRow(Values));
+}
+
+TEST(DSVProjectionReader, HeaderAndInference){
+    std::string Data = "id,name,price,count,notes\n1,apple,0.5,3,x\n2,pear,1,,y\n3,plum,2.25,7,z\n";
+    std::vector< SDSVColumn > Columns(4);
+    Columns[0].DName = "count";
+    Columns[1].DName = "price";
+    Columns[2].DName = "name";
+    Columns[3].DName = "id";
+    CDSVProjectionReader Reader(std::make_shared<CStringDataSource>(Data), ',', Columns, true, 2);
+    std::vector< SDSVValue > Values;
+
+    ASSERT_TRUE(Reader.Valid());
+    EXPECT_EQ(Reader.Columns()[0].DIndex, 3);
+    EXPECT_EQ(Reader.Columns()[0].DType, EDSVColumnType::Integer);
+    EXPECT_EQ(Reader.Columns()[1].DType, EDSVColumnType::Double);
+    EXPECT_EQ(Reader.Columns()[2].DType, EDSVColumnType::String);
+    EXPECT_EQ(Reader.Columns()[3].DType, EDSVColumnType::Integer);
+
+    ASSERT_TRUE(Reader.ReadRow(Values));
+    EXPECT_EQ(Values[0].DInteger, 3);
+    EXPECT_DOUBLE_EQ(Values[1].DDouble, 0.5);
+    EXPECT_EQ(Values[2].DString, "apple");
+    EXPECT_EQ(Values[3].DInteger, 1);
+
+    ASSERT_TRUE(Reader.ReadRow(Values));
+    EXPECT_FALSE(Values[0].DValid);
+    EXPECT_DOUBLE_EQ(Values[1].DDouble, 1.0);
+
+    ASSERT_TRUE(Reader.ReadRow(Values));
+    EXPECT_EQ(Values[0].DInteger, 7);
+    EXPECT_EQ(Values[2].DString, "plum");
+    EXPECT_EQ(Values[3].DInteger, 3);
+
+    EXPECT_TRUE(Reader.End());
+}
+
+TEST(DSVProjectionReader, UnknownColumn){
+    std::vector< SDSVColumn > Columns(1);
+    Columns[0].DName = "missing";
+    CDSVProjectionReader Reader(std::make_shared<CStringDataSource>("a,b\n1,2\n"), ',', Columns, true);
+    std::vector< SDSVValue > Values;
+
+    EXPECT_FALSE(Reader.Valid());
+    ASSERT_TRUE(Reader.ReadRow(Values));
+    EXPECT_FALSE(Values[0].DValid);
+}
+
+// one source column projected into two slots fills both
+TEST(DSVProjectionReader, DuplicatedColumn){
+    std::string Data = "id,qty\n7,12\n8,x\n";
+    std::vector< SDSVColumn > Columns(3);
+    Columns[0].DName = "qty";
+    Columns[0].DType = EDSVColumnType::String;
+    Columns[1].DName = "qty";
+    Columns[2].DName = "qty";
+    Columns[2].DType = EDSVColumnType::Integer;
+    CDSVProjectionReader Reader(std::make_shared<CStringDataSource>(Data), ',', Columns, true);
+    std::vector< SDSVValue > Values;
+
+    ASSERT_TRUE(Reader.Valid());
+    EXPECT_EQ(Reader.Columns()[1].DType, EDSVColumnType::String);
+
+    ASSERT_TRUE(Reader.ReadRow(Values));
+    EXPECT_TRUE(Values[0].DValid);
+    EXPECT_EQ(Values[0].DString, "12");
+    EXPECT_EQ(Values[1].DString, "12");
+    EXPECT_TRUE(Values[2].DValid);
+    EXPECT_EQ(Values[2].DInteger, 12);
+
+    ASSERT_TRUE(Reader.ReadRow(Values));
+    EXPECT_EQ(Values[0].DString, "x");
+    EXPECT_EQ(Values[1].DString, "x");
+    EXPECT_FALSE(Values[2].DValid);
+    EXPECT_FALSE(Reader.ReadRow(Values));
+}
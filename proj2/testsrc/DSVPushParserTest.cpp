@@ -0,0 +1,172 @@
+#include "gtest/gtest.h"
+#include "DSVPushParser.h"
+#include "DSVReader.h"
+#include "StringDataSource.h"
+#include <vector>
+#include <string>
+
+namespace{
+
+std::vector<std::vector<std::string>> PullRows(const std::string &data, const SDSVReadOptions &options){
+    CDSVReader reader(std::make_shared<CStringDataSource>(data), ',', options);
+    std::vector<std::vector<std::string>> rows;
+    std::vector<std::string> row;
+    while(reader.ReadRow(row)){
+        rows.push_back(row);
+    }
+    return rows;
+}
+
+// Source handing out one byte per read
+class COneByteSource : public CDataSource{
+    private:
+        std::string DData;
+        std::size_t DIndex = 0;
+
+    public:
+        COneByteSource(std::string data) : DData(std::move(data)){
+
+        }
+
+        bool End() const noexcept override{
+            return DIndex >= DData.size();
+        }
+
+        bool Get(char &ch) noexcept override{
+            if(End()){
+                return false;
+            }
+            ch = DData[DIndex++];
+            return true;
+        }
+
+        bool Peek(char &ch) noexcept override{
+            if(End()){
+                return false;
+            }
+            ch = DData[DIndex];
+            return true;
+        }
+
+        bool Read(std::vector<char> &buf, std::size_t count) noexcept override{
+            buf.clear();
+            char Ch;
+            if(count && Get(Ch)){
+                buf.push_back(Ch);
+            }
+            return !buf.empty();
+        }
+};
+
+std::vector<std::vector<std::string>> DrainRows(CDSVPushParser &parser){
+    std::vector<std::vector<std::string>> rows;
+    std::vector<std::string> row;
+    while(parser.ReadRow(row)){
+        rows.push_back(row);
+    }
+    return rows;
+}
+
+}
+
+// rows are returned as soon as they are complete
+TEST(DSVPushParserTest, RowsAsTheyComplete) {
+    CDSVPushParser parser(',');
+    std::vector<std::string> row;
+
+    EXPECT_TRUE(parser.Feed("a,b\nc,"));
+    EXPECT_EQ(parser.RowsReady(), 1);
+    ASSERT_TRUE(parser.ReadRow(row));
+    EXPECT_EQ(row, (std::vector<std::string>{"a", "b"}));
+    EXPECT_FALSE(parser.ReadRow(row));
+
+    EXPECT_TRUE(parser.Feed("d\ne"));
+    ASSERT_TRUE(parser.ReadRow(row));
+    EXPECT_EQ(row, (std::vector<std::string>{"c", "d"}));
+    EXPECT_FALSE(parser.End());
+
+    EXPECT_TRUE(parser.Finish());
+    ASSERT_TRUE(parser.ReadRow(row));
+    EXPECT_EQ(row, (std::vector<std::string>{"e"}));
+    EXPECT_TRUE(parser.End());
+}
+
+// quotes and escapes split across chunks at every possible point
+TEST(DSVPushParserTest, SplitAnywhere) {
+    std::string data = "\xEF\xBB\xBF" "name,\"quoted, \"\"value\"\"\"\r\n\"multi\nline\",x\r\ny\rz,\"\"\n\"end\"\"\"";
+    SDSVReadOptions options;
+    options.DStripCR = true;
+    options.DSkipBOM = true;
+    auto expected = PullRows(data, options);
+    ASSERT_EQ(expected.size(), 4);
+    EXPECT_EQ(expected[0], (std::vector<std::string>{"name", "quoted, \"value\""}));
+
+    for(std::size_t split = 0; split <= data.size(); split++){
+        CDSVPushParser parser(',', options);
+        parser.Feed(data.substr(0, split));
+        parser.Feed(data.substr(split));
+        parser.Finish();
+        EXPECT_EQ(DrainRows(parser), expected) << "split at " << split;
+    }
+
+    // one byte at a time
+    CDSVPushParser parser(',', options);
+    for(char ch : data){
+        parser.Feed(&ch, 1);
+    }
+    parser.Finish();
+    EXPECT_EQ(DrainRows(parser), expected);
+}
+
+// a lone BOM prefix that turns out not to be one is kept as data
+// the pull reader driven by one byte reads scans the same rows
+TEST(DSVPushParserTest, PullReaderShortReads) {
+    std::string data = "\xEF\xBB\xBF" "name,\"quoted, \"\"value\"\"\"\r\n\"multi\nline\",x\r\ny\rz,\"\"\n\"end\"\"\"";
+    SDSVReadOptions options;
+    options.DStripCR = true;
+    options.DSkipBOM = true;
+    auto expected = PullRows(data, options);
+
+    CDSVReader reader(std::make_shared<COneByteSource>(data), ',', options);
+    std::vector<std::vector<std::string>> rows;
+    std::vector<std::string> row;
+    while(reader.ReadRow(row)){
+        rows.push_back(row);
+    }
+    EXPECT_EQ(rows, expected);
+}
+
+TEST(DSVPushParserTest, PartialBOM) {
+    SDSVReadOptions options;
+    options.DSkipBOM = true;
+    CDSVPushParser parser(',', options);
+    parser.Feed("\xEF");
+    parser.Feed("\xBB" "x\n");
+    parser.Finish();
+    auto rows = DrainRows(parser);
+    ASSERT_EQ(rows.size(), 1);
+    EXPECT_EQ(rows[0][0], "\xEF\xBB" "x");
+}
+
+// error policies match the pull reader
+TEST(DSVPushParserTest, ErrorPolicies) {
+    std::string data = "a,b\nc,\"d\"x\ne,f\n\"g";
+    SDSVReadOptions options;
+    options.DErrorPolicy = EDSVErrorPolicy::SkipRow;
+    CDSVPushParser skipping(',', options);
+    EXPECT_TRUE(skipping.Feed(data));
+    EXPECT_TRUE(skipping.Finish());
+    EXPECT_EQ(DrainRows(skipping), PullRows(data, options));
+    ASSERT_EQ(skipping.Errors().size(), 2);
+    EXPECT_EQ(skipping.Errors()[0].DType, SDSVError::EType::DataAfterQuote);
+    EXPECT_EQ(skipping.Errors()[0].DOffset, 9);
+    EXPECT_EQ(skipping.Errors()[1].DType, SDSVError::EType::UnterminatedQuote);
+    EXPECT_EQ(skipping.Errors()[1].DRow, 3);
+
+    options.DErrorPolicy = EDSVErrorPolicy::Fail;
+    CDSVPushParser failing(',', options);
+    EXPECT_FALSE(failing.Feed(data));
+    EXPECT_FALSE(failing.Finish());
+    auto rows = DrainRows(failing);
+    EXPECT_EQ(rows, (std::vector<std::vector<std::string>>{{"a", "b"}, {"e", "f"}}));
+}
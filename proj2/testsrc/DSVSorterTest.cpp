@@ -0,0 +1,127 @@
+#include "gtest/gtest.h"
+#include "DSVSorter.h"
+#include "DSVReader.h"
+#include "StringDataSource.h"
+#include "StringDataSink.h"
+#include <algorithm>
+#include <random>
+
+namespace{
+
+std::vector<std::vector<std::string>> ReadAll(const std::string &data){
+    CDSVReader Reader(std::make_shared<CStringDataSource>(data), ',');
+    std::vector<std::vector<std::string>> Rows;
+    std::vector<std::string> Row;
+    while(Reader.ReadRow(Row)){
+        Rows.push_back(Row);
+    }
+    return Rows;
+}
+
+}
+
+// small input is sorted in memory, quoting survives the round trip
+TEST(DSVSorterTest, InMemory){
+    std::string Input = "name,count\n\"b, with comma\",10\n\"a \"\"quoted\"\"\",9\nb,2\n";
+    auto Sink = std::make_shared<CStringDataSink>();
+    CDSVSorter Sorter({SDSVSortKey{1, EDSVSortType::Integer}});
+    EXPECT_TRUE(Sorter.Sort(std::make_shared<CStringDataSource>(Input), Sink, ',', true));
+    EXPECT_EQ(Sorter.RunCount(), 1);
+    EXPECT_EQ(Sink->String(), "name,count\nb,2\n\"a \"\"quoted\"\"\",9\n\"b, with comma\",10\n");
+
+    // as strings "10" sorts before "2"
+    auto StringSink = std::make_shared<CStringDataSink>();
+    CDSVSorter StringSorter({SDSVSortKey{1}});
+    EXPECT_TRUE(StringSorter.Sort(std::make_shared<CStringDataSource>(Input), StringSink, ',', true));
+    EXPECT_EQ(ReadAll(StringSink->String())[1][1], "10");
+}
+
+// runs spilled to temporary files and merged give the same order as an
+// in-memory stable sort
+TEST(DSVSorterTest, ExternalMerge){
+    std::mt19937 Generator(7);
+    std::vector<std::vector<std::string>> Rows;
+    std::string Input;
+    for(int Index = 0; Index < 20000; Index++){
+        std::vector<std::string> Row = {std::to_string(int(Generator() % 100) - 50), std::to_string((Generator() % 1000) / 8.0), "row " + std::to_string(Index)};
+        if(Index % 97 == 0){
+            Row[0] = "n/a";
+        }
+        Input += Row[0] + "," + Row[1] + "," + Row[2] + "\n";
+        Rows.push_back(Row);
+    }
+    std::stable_sort(Rows.begin(), Rows.end(), [](const std::vector<std::string> &left, const std::vector<std::string> &right){
+        bool LeftValid = left[0] != "n/a";
+        bool RightValid = right[0] != "n/a";
+        if(LeftValid != RightValid){
+            return !LeftValid;
+        }
+        if(LeftValid && std::stoi(left[0]) != std::stoi(right[0])){
+            return std::stoi(left[0]) < std::stoi(right[0]);
+        }
+        return std::stod(left[1]) > std::stod(right[1]);
+    });
+
+    auto Sink = std::make_shared<CStringDataSink>();
+    CDSVSorter Sorter({SDSVSortKey{0, EDSVSortType::Integer}, SDSVSortKey{1, EDSVSortType::Double, true}}, 256 * 1024, 3);
+    EXPECT_TRUE(Sorter.Sort(std::make_shared<CStringDataSource>(Input), Sink, ',', false));
+    EXPECT_GT(Sorter.RunCount(), 4);
+    EXPECT_EQ(ReadAll(Sink->String()), Rows);
+}
+
+// a budget too small for more than two merge readers forces many more runs
+// than the fan-in, which are merged in several passes
+TEST(DSVSorterTest, MultiPassMerge){
+    std::mt19937 Generator(11);
+    std::vector<std::vector<std::string>> Rows;
+    std::string Input;
+    for(int Index = 0; Index < 2000; Index++){
+        std::vector<std::string> Row = {std::to_string(Generator() % 50), "row " + std::to_string(Index)};
+        Input += Row[0] + "," + Row[1] + "\n";
+        Rows.push_back(Row);
+    }
+    std::stable_sort(Rows.begin(), Rows.end(), [](const std::vector<std::string> &left, const std::vector<std::string> &right){
+        return std::stoi(left[0]) < std::stoi(right[0]);
+    });
+
+    auto Sink = std::make_shared<CStringDataSink>();
+    CDSVSorter Sorter({SDSVSortKey{0, EDSVSortType::Integer}}, 4096, 2);
+    EXPECT_TRUE(Sorter.Sort(std::make_shared<CStringDataSource>(Input), Sink, ',', false));
+    EXPECT_GT(Sorter.RunCount(), 100);
+    EXPECT_EQ(ReadAll(Sink->String()), Rows);
+}
+
+// NaN keys sort with the values that are not numbers, in string order,
+// also when the runs are merged
+TEST(DSVSorterTest, NaNKeys){
+    std::string Input;
+    std::vector<std::vector<std::string>> Expected;
+    for(int Index = 0; Index < 400; Index++){
+        std::string Key = Index % 5 == 0 ? (Index % 10 ? "nan" : "-nan") : std::to_string((Index * 37) % 101) + ".5";
+        Input += Key + "," + std::to_string(Index) + "\n";
+        Expected.push_back({Key, std::to_string(Index)});
+    }
+    std::stable_sort(Expected.begin(), Expected.end(), [](const std::vector<std::string> &left, const std::vector<std::string> &right){
+        bool LeftNaN = left[0].find("nan") != std::string::npos;
+        bool RightNaN = right[0].find("nan") != std::string::npos;
+        if(LeftNaN || RightNaN){
+            return LeftNaN != RightNaN ? LeftNaN : left[0] < right[0];
+        }
+        return std::stod(left[0]) < std::stod(right[0]);
+    });
+
+    for(std::size_t Budget : {std::size_t(1) << 20, std::size_t(4096)}){
+        auto Sink = std::make_shared<CStringDataSink>();
+        CDSVSorter Sorter({SDSVSortKey{0, EDSVSortType::Double}}, Budget, 2);
+        EXPECT_TRUE(Sorter.Sort(std::make_shared<CStringDataSource>(Input), Sink, ','));
+        EXPECT_EQ(ReadAll(Sink->String()), Expected);
+    }
+}
+
+TEST(DSVSorterTest, EmptyInput){
+    auto Sink = std::make_shared<CStringDataSink>();
+    CDSVSorter Sorter({SDSVSortKey{0}});
+    EXPECT_TRUE(Sorter.Sort(std::make_shared<CStringDataSource>(""), Sink, ',', true));
+    EXPECT_EQ(Sorter.RunCount(), 0);
+    EXPECT_EQ(Sink->String(), "");
+}
@@ -1,10 +1,13 @@
 #include "gtest/gtest.h"
 #include "DSVReader.h"
 #include "DSVWriter.h"
+#include "DSVReaderT.h"
+#include "DSVWriterT.h"
 #include "StringDataSource.h"
 #include "StringDataSink.h"
 #include <vector>
 #include <string>
+#include <memory_resource>
 
 // simple DSV file (two rows)
 TEST(DSVReaderTest, SimpleDSV) {
@@ -111,4 +114,244 @@ TEST(DSVWriterTest, TrailingDelimiter) {
 
     std::string expected = "Name,Age,Location,\nJane,25,Davis,\n";
     EXPECT_EQ(sink->String(), expected);
-}
\ No newline at end of file
+}
+
+// row strings are reused between reads, values are longer than the small
+// string buffer so their heap storage is what gets compared
+TEST(DSVReaderTest, ReusesRowStorage) {
+    std::string wide(100, 'w');
+    std::string narrow(40, 'n');
+    std::string data = wide + "," + wide + "," + wide + "\n" + narrow + "," + narrow + "," + narrow + "\n" + narrow + "\n" + narrow + "," + narrow + "," + narrow + "\n";
+    auto source = std::make_shared<CStringDataSource>(data);
+    CDSVReader reader(source, ',');
+
+    std::vector<std::string> row;
+    ASSERT_TRUE(reader.ReadRow(row));
+    std::vector<const char *> storage;
+    std::vector<std::size_t> capacity;
+    for(auto &Value : row){
+        storage.push_back(Value.data());
+        capacity.push_back(Value.capacity());
+    }
+
+    ASSERT_TRUE(reader.ReadRow(row));
+    EXPECT_EQ(row, (std::vector<std::string>{narrow, narrow, narrow}));
+    for(std::size_t Index = 0; Index < row.size(); Index++){
+        EXPECT_EQ(row[Index].data(), storage[Index]);
+        EXPECT_EQ(row[Index].capacity(), capacity[Index]);
+    }
+
+    // a narrow row keeps the buffers of the values it drops for later rows
+    ASSERT_TRUE(reader.ReadRow(row));
+    EXPECT_EQ(row, (std::vector<std::string>{narrow}));
+    EXPECT_EQ(row[0].data(), storage[0]);
+
+    ASSERT_TRUE(reader.ReadRow(row));
+    EXPECT_EQ(row, (std::vector<std::string>{narrow, narrow, narrow}));
+    for(std::size_t Index = 0; Index < row.size(); Index++){
+        EXPECT_EQ(row[Index].data(), storage[Index]);
+        EXPECT_EQ(row[Index].capacity(), capacity[Index]);
+    }
+}
+
+// string_view rows
+TEST(DSVWriterTest, StringViewRow) {
+    auto sink = std::make_shared<CStringDataSink>();
+    CDSVWriter writer(sink, ',');
+
+    std::string_view row[] = {"Jane", "25", "New, \"York\""};
+
+    ASSERT_TRUE(writer.WriteRow(row, 3));
+    ASSERT_TRUE(writer.WriteRow(row, 0));
+
+    std::string expected = "Jane,25,\"New, \"\"York\"\"\"\n\n";
+    EXPECT_EQ(sink->String(), expected);
+}
+
+
+// compile time CSV dialect, doubled quotes and newlines inside quotes
+TEST(DSVReaderTest, StaticCSVDialect) {
+    std::string data = "a,\"b \"\"c\"\"\",\"d\ne\"\nf,g";
+    auto source = std::make_shared<CStringDataSource>(data);
+    CCSVReader reader(source);
+
+    std::vector<std::string> row;
+    ASSERT_TRUE(reader.ReadRow(row));
+    EXPECT_EQ(row, (std::vector<std::string>{"a", "b \"c\"", "d\ne"}));
+
+    ASSERT_TRUE(reader.ReadRow(row));
+    EXPECT_EQ(row, (std::vector<std::string>{"f", "g"}));
+
+    EXPECT_TRUE(reader.End());
+    EXPECT_FALSE(reader.ReadRow(row));
+}
+
+// TSV has no quoting so quotes are ordinary data
+TEST(DSVReaderTest, StaticTSVDialect) {
+    std::string data = "\"a\"\tb,c\n1\t2\n";
+    auto source = std::make_shared<CStringDataSource>(data);
+    CTSVReader reader(source);
+
+    std::vector<std::string> row;
+    ASSERT_TRUE(reader.ReadRow(row));
+    EXPECT_EQ(row, (std::vector<std::string>{"\"a\"", "b,c"}));
+
+    ASSERT_TRUE(reader.ReadRow(row));
+    EXPECT_EQ(row, (std::vector<std::string>{"1", "2"}));
+
+    EXPECT_TRUE(reader.End());
+}
+
+// rows longer than the internal block size
+TEST(DSVReaderTest, LongRows) {
+    std::string longValue(10000, 'x');
+    std::string data = longValue + ",\"" + longValue + "\"\"\"\n";
+    auto source = std::make_shared<CStringDataSource>(data);
+    CDSVReader reader(source, ',');
+
+    std::vector<std::string> row;
+    ASSERT_TRUE(reader.ReadRow(row));
+    EXPECT_EQ(row, (std::vector<std::string>{longValue, longValue + "\""}));
+    EXPECT_TRUE(reader.End());
+}
+
+// compile time writer dialects
+TEST(DSVWriterTest, StaticDialects) {
+    auto csvSink = std::make_shared<CStringDataSink>();
+    CCSVWriter csvWriter(csvSink);
+    auto quotedSink = std::make_shared<CStringDataSink>();
+    CDSVWriterT<'|', '\'', true> quotedWriter(quotedSink);
+    auto tsvSink = std::make_shared<CStringDataSink>();
+    CTSVWriter tsvWriter(tsvSink);
+
+    std::vector<std::string> row = {"a", "b,c", "it's \"x\""};
+
+    ASSERT_TRUE(csvWriter.WriteRow(row));
+    ASSERT_TRUE(quotedWriter.WriteRow(row));
+    ASSERT_TRUE(tsvWriter.WriteRow(row));
+
+    EXPECT_EQ(csvSink->String(), "a,\"b,c\",\"it's \"\"x\"\"\"\n");
+    EXPECT_EQ(quotedSink->String(), "'a'|'b,c'|'it''s \"x\"'\n");
+    EXPECT_EQ(tsvSink->String(), "a\tb,c\tit's \"x\"\n");
+}
+
+// without quoting a value holding the delimiter would add a column
+TEST(DSVWriterTest, UnquotedDelimiterRejected) {
+    auto sink = std::make_shared<CStringDataSink>();
+    CTSVWriter writer(sink);
+
+    std::vector<std::string> row = {"a", "b\tc"};
+    EXPECT_FALSE(writer.WriteRow(row));
+    EXPECT_EQ(sink->String(), "");
+    ASSERT_TRUE(writer.WriteRow({"a", "b"}));
+    EXPECT_EQ(sink->String(), "a\tb\n");
+}
+
+// without quoting a value holding a newline would split the row
+TEST(DSVWriterTest, UnquotedNewlineRejected) {
+    auto sink = std::make_shared<CStringDataSink>();
+    CTSVWriter writer(sink);
+
+    std::string_view fields[] = {"a", "b\nc"};
+    EXPECT_FALSE(writer.WriteRow(fields, 2));
+    EXPECT_EQ(sink->String(), "");
+}
+
+
+// CRLF line endings and a byte order mark
+TEST(DSVReaderTest, CRLFAndBOM) {
+    std::string data = "\xEF\xBB\xBFName,Age\r\n\"Jane\",\"a\r\nb\"\r\nBob,x\ry\r\n";
+    SDSVReadOptions options;
+    options.DStripCR = true;
+    options.DSkipBOM = true;
+    CDSVReader reader(std::make_shared<CStringDataSource>(data), ',', options);
+
+    std::vector<std::string> row;
+    ASSERT_TRUE(reader.ReadRow(row));
+    EXPECT_EQ(row, (std::vector<std::string>{"Name", "Age"}));
+    ASSERT_TRUE(reader.ReadRow(row));
+    EXPECT_EQ(row, (std::vector<std::string>{"Jane", "a\r\nb"}));
+    ASSERT_TRUE(reader.ReadRow(row));
+    EXPECT_EQ(row, (std::vector<std::string>{"Bob", "x\ry"}));
+    EXPECT_TRUE(reader.End());
+    EXPECT_TRUE(reader.Errors().empty());
+
+    // without the options both are kept as data
+    CDSVReader plain(std::make_shared<CStringDataSource>(data), ',');
+    ASSERT_TRUE(plain.ReadRow(row));
+    EXPECT_EQ(row, (std::vector<std::string>{"\xEF\xBB\xBFName", "Age\r"}));
+}
+
+// malformed rows are reported with their position
+TEST(DSVReaderTest, ReportErrors) {
+    std::string data = "a,b\nc,d\"e\"\nf,\"g\"h\ni,j\n\"k";
+    SDSVReadOptions options;
+    options.DErrorPolicy = EDSVErrorPolicy::Report;
+    CDSVReader reader(std::make_shared<CStringDataSource>(data), ',', options);
+
+    std::vector<std::string> row;
+    ASSERT_TRUE(reader.ReadRow(row));
+    ASSERT_TRUE(reader.ReadRow(row));
+    ASSERT_EQ(reader.Errors().size(), 1);
+    EXPECT_EQ(reader.Errors()[0].DType, SDSVError::EType::QuoteInValue);
+    EXPECT_EQ(reader.Errors()[0].DOffset, 7);
+    EXPECT_EQ(reader.Errors()[0].DRow, 1);
+    EXPECT_EQ(reader.Errors()[0].DColumn, 1);
+
+    while (reader.ReadRow(row)) {
+    }
+    ASSERT_EQ(reader.Errors().size(), 3);
+    EXPECT_EQ(reader.Errors()[1].DType, SDSVError::EType::DataAfterQuote);
+    EXPECT_EQ(reader.Errors()[1].DOffset, data.find('h'));
+    EXPECT_EQ(reader.Errors()[1].DRow, 2);
+    EXPECT_EQ(reader.Errors()[2].DType, SDSVError::EType::UnterminatedQuote);
+    EXPECT_EQ(reader.Errors()[2].DRow, 4);
+    EXPECT_EQ(reader.Errors()[2].DColumn, 0);
+
+    reader.ClearErrors();
+    EXPECT_TRUE(reader.Errors().empty());
+}
+
+// skip bad rows policy
+TEST(DSVReaderTest, SkipBadRows) {
+    std::string data = "a,b\nc,\"d\"x\ne,f\n\"g";
+    SDSVReadOptions options;
+    options.DErrorPolicy = EDSVErrorPolicy::SkipRow;
+    CDSVReader reader(std::make_shared<CStringDataSource>(data), ',', options);
+
+    std::vector<std::string> row;
+    ASSERT_TRUE(reader.ReadRow(row));
+    EXPECT_EQ(row, (std::vector<std::string>{"a", "b"}));
+    ASSERT_TRUE(reader.ReadRow(row));
+    EXPECT_EQ(row, (std::vector<std::string>{"e", "f"}));
+    EXPECT_FALSE(reader.ReadRow(row));
+    EXPECT_EQ(reader.Errors().size(), 2);
+
+    options.DErrorPolicy = EDSVErrorPolicy::Fail;
+    CDSVReader failing(std::make_shared<CStringDataSource>(data), ',', options);
+    ASSERT_TRUE(failing.ReadRow(row));
+    EXPECT_FALSE(failing.ReadRow(row));
+    ASSERT_TRUE(failing.ReadRow(row));
+    EXPECT_EQ(row, (std::vector<std::string>{"e", "f"}));
+}
+
+// rows read into a memory resource
+TEST(DSVReaderTest, PmrRows) {
+    std::string data = "a much longer first value,b\nc,another value that is long\n";
+    char arena[4096];
+    std::pmr::monotonic_buffer_resource resource(arena, sizeof(arena), std::pmr::null_memory_resource());
+    CDSVReader reader(std::make_shared<CStringDataSource>(data), ',');
+
+    std::pmr::vector<std::pmr::string> row(&resource);
+    ASSERT_TRUE(reader.ReadRow(row));
+    ASSERT_EQ(row.size(), 2);
+    EXPECT_EQ(row[0], "a much longer first value");
+    EXPECT_EQ(row[1], "b");
+    EXPECT_EQ(row[0].get_allocator().resource(), &resource);
+    EXPECT_TRUE(row[0].data() >= arena && row[0].data() < arena + sizeof(arena));
+
+    ASSERT_TRUE(reader.ReadRow(row));
+    EXPECT_EQ(row[1], "another value that is long");
+    EXPECT_TRUE(row[1].data() >= arena && row[1].data() < arena + sizeof(arena));
+    EXPECT_FALSE(reader.ReadRow(row));
+}
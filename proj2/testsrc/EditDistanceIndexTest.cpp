@@ -0,0 +1,96 @@
+#include "gtest/gtest.h"
+#include "EditDistanceIndex.h"
+#include "StringUtils.h"
+#include <random>
+
+namespace{
+
+std::vector<std::string> RandomWords(std::size_t count, unsigned seed){
+    std::mt19937 Generator(seed);
+    std::uniform_int_distribution<int> Length(0, 8);
+    std::uniform_int_distribution<int> Letter(0, 5);
+    std::vector<std::string> Words;
+    for(std::size_t Index = 0; Index < count; Index++){
+        std::string Word;
+        for(int Position = Length(Generator); Position > 0; Position--){
+            Word.push_back("abcABC"[Letter(Generator)]);
+        }
+        Words.push_back(Word);
+    }
+    return Words;
+}
+
+std::vector<SEditDistanceMatch> BruteForce(const std::vector<std::string> &entries, const std::string &query, int maxdistance, bool ignorecase){
+    std::vector<SEditDistanceMatch> Matches;
+    for(int Distance = 0; Distance <= maxdistance; Distance++){
+        for(std::size_t Index = 0; Index < entries.size(); Index++){
+            if(StringUtils::EditDistance(entries[Index], query, ignorecase) == Distance){
+                Matches.push_back(SEditDistanceMatch{Index, Distance});
+            }
+        }
+    }
+    return Matches;
+}
+
+void ExpectSameMatches(const std::vector<SEditDistanceMatch> &actual, const std::vector<SEditDistanceMatch> &expected){
+    ASSERT_EQ(actual.size(), expected.size());
+    for(std::size_t Index = 0; Index < actual.size(); Index++){
+        EXPECT_EQ(actual[Index].DIndex, expected[Index].DIndex);
+        EXPECT_EQ(actual[Index].DDistance, expected[Index].DDistance);
+    }
+}
+
+}
+
+TEST(EditDistanceIndex, SimpleLookup){
+    CEditDistanceIndex Index;
+    Index.Add("kitten");
+    Index.Add("sitting");
+    Index.Add("mitten");
+    Index.Add("kitten");
+    EXPECT_EQ(Index.Size(), 4);
+    EXPECT_EQ(Index.Entry(1), "sitting");
+
+    auto Matches = Index.Find("kitten", 1);
+    ASSERT_EQ(Matches.size(), 3);
+    EXPECT_EQ(Matches[0].DIndex, 0);
+    EXPECT_EQ(Matches[1].DIndex, 3);
+    EXPECT_EQ(Matches[2].DIndex, 2);
+    EXPECT_EQ(Matches[2].DDistance, 1);
+    EXPECT_EQ(Index.Find("kitten", 3).size(), 4);
+    EXPECT_TRUE(Index.Find("kitten", -1).empty());
+    EXPECT_TRUE(CEditDistanceIndex().Find("kitten", 2).empty());
+}
+
+// results match a scan with StringUtils::EditDistance
+TEST(EditDistanceIndex, MatchesBruteForce){
+    auto Entries = RandomWords(2000, 1);
+    auto Queries = RandomWords(50, 2);
+    for(bool IgnoreCase : {false, true}){
+        CEditDistanceIndex Index(IgnoreCase);
+        for(auto &Entry : Entries){
+            Index.Add(Entry);
+        }
+        for(int MaxDistance : {0, 1, 2}){
+            for(auto &Query : Queries){
+                ExpectSameMatches(Index.Find(Query, MaxDistance), BruteForce(Entries, Query, MaxDistance, IgnoreCase));
+            }
+        }
+    }
+}
+
+// bulk queries on several threads give the single query results in order
+TEST(EditDistanceIndex, ParallelBulkQueries){
+    auto Entries = RandomWords(3000, 3);
+    auto Queries = RandomWords(400, 4);
+    CEditDistanceIndex Index(true);
+    for(auto &Entry : Entries){
+        Index.Add(Entry);
+    }
+    auto Results = Index.FindAll(Queries, 1, 4);
+    ASSERT_EQ(Results.size(), Queries.size());
+    for(std::size_t Query = 0; Query < Queries.size(); Query++){
+        ExpectSameMatches(Results[Query], Index.Find(Queries[Query], 1));
+    }
+    EXPECT_TRUE(Index.FindAll({}, 1).empty());
+}
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include "ParallelXMLReader.h"
+#include "XMLReader.h"
+#include "StringDataSource.h"
+
+namespace{
+
+std::string MakeDocument(std::size_t records){
+    std::string Data = "<?xml version=\"1.0\"?>\n<!-- feed --><feed version=\"2\">";
+    for(std::size_t Index = 0; Index < records; Index++){
+        Data += "<record id=\"" + std::to_string(Index) + "\" note=\"a>b\"><name>n" + std::to_string(Index) + " &amp; co</name>";
+        Data += "<!-- <fake> --><![CDATA[<x>]]><empty/></record>";
+        if(Index % 10 == 0){
+            Data += "<marker/>";
+        }
+    }
+    return Data + "</feed>";
+}
+
+std::vector< SXMLEntity > ReadAll(CXMLReader &reader){
+    std::vector< SXMLEntity > Entities;
+    SXMLEntity Entity;
+    while(reader.ReadEntity(Entity, true)){
+        Entities.push_back(Entity);
+    }
+    return Entities;
+}
+
+}
+
+TEST(ParallelXMLReader, MatchesSequentialReader){
+    std::string Data = MakeDocument(5000);
+    CXMLReader Sequential(std::make_shared<CStringDataSource>(Data));
+    CParallelXMLReader Parallel(std::make_shared<CStringDataSource>(Data), 4);
+    std::vector< SXMLEntity > Expected = ReadAll(Sequential);
+    SXMLEntity Entity;
+
+    ASSERT_GT(Expected.size(), 5000);
+    for(auto &ExpectedEntity : Expected){
+        ASSERT_TRUE(Parallel.ReadEntity(Entity, true));
+        ASSERT_EQ(Entity.DType, ExpectedEntity.DType);
+        ASSERT_EQ(Entity.DNameData, ExpectedEntity.DNameData);
+        ASSERT_EQ(Entity.DAttributes, ExpectedEntity.DAttributes);
+    }
+    EXPECT_FALSE(Parallel.ReadEntity(Entity));
+    EXPECT_TRUE(Parallel.End());
+}
+
+TEST(ParallelXMLReader, CharData){
+    CParallelXMLReader Reader(std::make_shared<CStringDataSource>(MakeDocument(3)), 2);
+    SXMLEntity Entity;
+    std::string Text;
+
+    while(Reader.ReadEntity(Entity)){
+        if(Entity.DType == SXMLEntity::EType::CharData){
+            Text += Entity.DNameData;
+        }
+    }
+    EXPECT_EQ(Text, "n0 & co<x>n1 & co<x>n2 & co<x>");
+}
+
+TEST(ParallelXMLReader, EmptyRoot){
+    CParallelXMLReader Reader(std::make_shared<CStringDataSource>("<feed a=\"1\"/>"), 2);
+    SXMLEntity Entity;
+
+    ASSERT_TRUE(Reader.ReadEntity(Entity));
+    EXPECT_EQ(Entity.DType, SXMLEntity::EType::StartElement);
+    EXPECT_EQ(Entity.AttributeValue("a"), "1");
+    ASSERT_TRUE(Reader.ReadEntity(Entity));
+    EXPECT_EQ(Entity.DType, SXMLEntity::EType::EndElement);
+    EXPECT_FALSE(Reader.ReadEntity(Entity));
+}
+
+TEST(ParallelXMLReader, MalformedRecord){
+    CParallelXMLReader Reader(std::make_shared<CStringDataSource>("<feed><r><a></r></feed>"), 2);
+    SXMLEntity Entity;
+
+    ASSERT_TRUE(Reader.ReadEntity(Entity));
+    EXPECT_EQ(Entity.DNameData, "feed");
+    EXPECT_FALSE(Reader.ReadEntity(Entity));
+    EXPECT_TRUE(Reader.End());
+}
+
+TEST(ParallelXMLReader, Truncated){
+    std::string Data = MakeDocument(100);
+    CParallelXMLReader Reader(std::make_shared<CStringDataSource>(Data.substr(0, Data.size() - 20)), 2);
+    SXMLEntity Entity;
+
+    bool RootClosed = false;
+
+    while(Reader.ReadEntity(Entity)){
+        RootClosed = RootClosed || (Entity.DType == SXMLEntity::EType::EndElement && Entity.DNameData == "feed");
+    }
+    EXPECT_FALSE(RootClosed);
+    EXPECT_TRUE(Reader.End());
+}
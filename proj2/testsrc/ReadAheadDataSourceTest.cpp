@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include "ReadAheadDataSource.h"
+#include "StringDataSource.h"
+#include "DSVReader.h"
+
+TEST(ReadAheadDataSource, EndTest){
+    CReadAheadDataSource EmptySource(std::make_shared<CStringDataSource>(""));
+    CReadAheadDataSource BaseSource(std::make_shared<CStringDataSource>("Hello"));
+
+    EXPECT_TRUE(EmptySource.End());
+    EXPECT_FALSE(BaseSource.End());
+}
+
+TEST(ReadAheadDataSource, GetPeekTest){
+    CReadAheadDataSource Source(std::make_shared<CStringDataSource>("Bye"), 2, 2);
+    char TempCh = 'x';
+
+    EXPECT_TRUE(Source.Peek(TempCh));
+    EXPECT_EQ(TempCh,'B');
+    EXPECT_TRUE(Source.Get(TempCh));
+    EXPECT_EQ(TempCh,'B');
+    EXPECT_TRUE(Source.Get(TempCh));
+    EXPECT_EQ(TempCh,'y');
+    EXPECT_TRUE(Source.Peek(TempCh));
+    EXPECT_EQ(TempCh,'e');
+    EXPECT_TRUE(Source.Get(TempCh));
+    EXPECT_EQ(TempCh,'e');
+    TempCh = 'x';
+    EXPECT_FALSE(Source.Peek(TempCh));
+    EXPECT_FALSE(Source.Get(TempCh));
+    EXPECT_EQ(TempCh,'x');
+    EXPECT_TRUE(Source.End());
+}
+
+TEST(ReadAheadDataSource, ReadTest){
+    std::string Text;
+    for(int Index = 0; Index < 100000; Index++){
+        Text += static_cast<char>('a' + Index % 26);
+    }
+    CReadAheadDataSource Source(std::make_shared<CStringDataSource>(Text), 1000, 3);
+    std::vector<char> TempVector;
+    std::string Result;
+
+    while(Source.Read(TempVector, 777)){
+        ASSERT_LE(TempVector.size(), 777);
+        Result.append(TempVector.data(), TempVector.size());
+    }
+    EXPECT_EQ(Result, Text);
+    EXPECT_TRUE(Source.End());
+}
+
+TEST(ReadAheadDataSource, EarlyDestruction){
+    std::string Text(100000, 'x');
+    CReadAheadDataSource Source(std::make_shared<CStringDataSource>(Text), 100, 2);
+    char TempCh;
+
+    EXPECT_TRUE(Source.Get(TempCh));
+}
+
+TEST(ReadAheadDataSource, DSVReaderTest){
+    std::string Text;
+    for(int Index = 0; Index < 1000; Index++){
+        Text += std::to_string(Index) + ",\"a\nb\"," + std::to_string(Index * 2) + "\n";
+    }
+    CDSVReader Reader(std::make_shared<CReadAheadDataSource>(std::make_shared<CStringDataSource>(Text), 64), ',');
+    std::vector<std::string> Row;
+
+    for(int Index = 0; Index < 1000; Index++){
+        ASSERT_TRUE(Reader.ReadRow(Row));
+        EXPECT_EQ(Row, (std::vector<std::string>{std::to_string(Index), "a\nb", std::to_string(Index * 2)}));
+    }
+    EXPECT_TRUE(Reader.End());
+}
@@ -0,0 +1,252 @@
+#include "gtest/gtest.h"
+#include "ReaderRange.h"
+#include "StringDataSource.h"
+#include <vector>
+#include <string>
+
+namespace{
+
+const std::string DSVData = "name,age\nalice,30\nbob,25\n\"carol, jr\",41\n";
+const std::string XMLData = "<root><item id=\"1\">one</item><item id=\"2\"/></root>";
+
+std::shared_ptr<CDSVReader> MakeDSVReader(const std::string &data){
+    return std::make_shared<CDSVReader>(std::make_shared<CStringDataSource>(data), ',');
+}
+
+std::shared_ptr<CXMLReader> MakeXMLReader(const std::string &data){
+    return std::make_shared<CXMLReader>(std::make_shared<CStringDataSource>(data));
+}
+
+}
+
+// range for visits the same rows ReadRow returns, through one reused row
+TEST(ReaderRangeTest, DSVRows) {
+    auto reader = MakeDSVReader(DSVData);
+    std::vector<std::vector<std::string>> rows;
+    const std::vector<std::string> *Previous = nullptr;
+    for(const auto &row : Rows(*reader)){
+        if(Previous){
+            EXPECT_EQ(Previous, &row);
+        }
+        Previous = &row;
+        rows.push_back(row);
+    }
+    ASSERT_EQ(rows.size(), 4);
+    EXPECT_EQ(rows[0], std::vector<std::string>({"name", "age"}));
+    EXPECT_EQ(rows[3], std::vector<std::string>({"carol, jr", "41"}));
+    EXPECT_TRUE(reader->End());
+
+    auto empty = MakeDSVReader("");
+    auto range = Rows(*empty);
+    EXPECT_TRUE(range.begin() == range.end());
+}
+
+// breaking out early leaves the remaining rows to the reader
+TEST(ReaderRangeTest, DSVRowsStopEarly) {
+    auto reader = MakeDSVReader(DSVData);
+    for(const auto &row : Rows(*reader)){
+        if(row[0] == "alice"){
+            break;
+        }
+    }
+    std::vector<std::string> row;
+    ASSERT_TRUE(reader->ReadRow(row));
+    EXPECT_EQ(row[0], "bob");
+}
+
+// rows completed by each Feed can be drained as a range
+TEST(ReaderRangeTest, PushParserRows) {
+    CDSVPushParser parser(',');
+    std::vector<std::string> names;
+    for(const std::string &chunk : {std::string("a,1\nb,"), std::string("2\nc,3"), std::string("\n")}){
+        parser.Feed(chunk);
+        for(const auto &row : Rows(parser)){
+            names.push_back(row[0]);
+        }
+    }
+    EXPECT_EQ(names, std::vector<std::string>({"a", "b", "c"}));
+}
+
+TEST(ReaderRangeTest, XMLEntities) {
+    auto reader = MakeXMLReader(XMLData);
+    std::vector<std::string> ids;
+    std::size_t Count = 0;
+    for(const auto &entity : Entities(*reader, true)){
+        EXPECT_NE(entity.DType, SXMLEntity::EType::CharData);
+        if(entity.AttributeExists("id")){
+            ids.push_back(entity.AttributeValue("id"));
+        }
+        Count++;
+    }
+    EXPECT_EQ(ids, std::vector<std::string>({"1", "2"}));
+    EXPECT_EQ(Count, 6);
+}
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+// ranges compose with the standard views without copying rows, take steps
+// the filter on to its next match before stopping
+TEST(ReaderRangeTest, ViewComposition) {
+    auto reader = MakeDSVReader(DSVData + "dave,52\nerin,19\n");
+    std::vector<std::string> names;
+    auto Adults = Rows(*reader)
+        | std::views::drop(1)
+        | std::views::filter([](const std::vector<std::string> &row){ return std::stoi(row[1]) >= 30; })
+        | std::views::take(1);
+    for(const auto &row : Adults){
+        names.push_back(row[0]);
+    }
+    EXPECT_EQ(names, std::vector<std::string>({"alice"}));
+    std::vector<std::string> row;
+    ASSERT_TRUE(reader->ReadRow(row));
+    EXPECT_EQ(row[0], "dave");
+}
+
+TEST(ReaderRangeTest, Generators) {
+    auto reader = MakeDSVReader(DSVData);
+    std::vector<std::string> names;
+    for(const auto &row : GenerateRows(*reader) | std::views::filter([](const std::vector<std::string> &row){ return row[1] != "25"; })){
+        names.push_back(row[0]);
+    }
+    EXPECT_EQ(names, std::vector<std::string>({"name", "alice", "carol, jr"}));
+
+    auto xmlReader = MakeXMLReader(XMLData);
+    std::vector<std::string> elements;
+    for(const auto &entity : GenerateEntities(*xmlReader, true) | std::views::take(2)){
+        elements.push_back(entity.DNameData);
+    }
+    EXPECT_EQ(elements, std::vector<std::string>({"root", "item"}));
+
+    // a generator dropped before it finishes frees its frame
+    auto another = MakeDSVReader(DSVData);
+    auto unfinished = GenerateRows(*another);
+    EXPECT_EQ((*unfinished.begin())[0], "name");
+}
+
+// each chunk fed to the parser is drained by a fresh generator
+TEST(ReaderRangeTest, PushParserGenerator) {
+    CDSVPushParser parser(',');
+    std::vector<std::string> names;
+    for(const std::string &chunk : {std::string("a,1\nb,"), std::string("2\n")}){
+        parser.Feed(chunk);
+        for(const auto &row : GenerateRows(parser)){
+            names.push_back(row[0]);
+        }
+    }
+    parser.Finish();
+    auto finished = GenerateRows(parser);
+    EXPECT_TRUE(finished.begin() == finished.end());
+    EXPECT_EQ(names, std::vector<std::string>({"a", "b"}));
+}
+
+namespace{
+
+// Eagerly started coroutine that stays alive until dropped
+struct STask{
+    struct promise_type{
+        STask get_return_object(){
+            return STask{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        std::suspend_never initial_suspend() noexcept{
+            return {};
+        }
+
+        std::suspend_always final_suspend() noexcept{
+            return {};
+        }
+
+        void return_void() noexcept{
+
+        }
+
+        void unhandled_exception(){
+            std::terminate();
+        }
+    };
+
+    std::coroutine_handle<promise_type> DHandle;
+
+    STask(std::coroutine_handle<promise_type> handle) : DHandle(handle){
+
+    }
+
+    STask(const STask &) = delete;
+
+    ~STask(){
+        DHandle.destroy();
+    }
+
+    bool Done() const{
+        return DHandle.done();
+    }
+};
+
+STask CollectNames(CDSVPushParser &parser, std::vector<std::string> &names){
+    auto Generator = GenerateRowsAsync(parser);
+    while(const auto *row = co_await Generator.Next()){
+        names.push_back((*row)[0]);
+    }
+}
+
+STask CountRows(CDSVPushParser &parser, std::size_t &count){
+    std::vector<std::string> Row;
+    while(co_await NextRow(parser, Row)){
+        count++;
+    }
+}
+
+}
+
+// consumers suspend while their parser has no row and are resumed by the
+// Feed or Finish that completes one, so one thread serves several streams
+TEST(ReaderRangeTest, AsyncGenerator) {
+    CDSVPushParser first(','), second(',');
+    std::vector<std::string> firstNames, secondNames;
+    STask firstTask = CollectNames(first, firstNames);
+    STask secondTask = CollectNames(second, secondNames);
+    EXPECT_TRUE(firstNames.empty());
+
+    first.Feed("a,1\nb,");
+    second.Feed("x");
+    EXPECT_EQ(firstNames, std::vector<std::string>({"a"}));
+    EXPECT_TRUE(secondNames.empty());
+
+    second.Feed(",1\ny,2\nz");
+    first.Feed("2\nc,3");
+    EXPECT_EQ(firstNames, std::vector<std::string>({"a", "b"}));
+    EXPECT_EQ(secondNames, std::vector<std::string>({"x", "y"}));
+    EXPECT_FALSE(firstTask.Done());
+
+    first.Finish();
+    EXPECT_TRUE(firstTask.Done());
+    EXPECT_EQ(firstNames, std::vector<std::string>({"a", "b", "c"}));
+    EXPECT_FALSE(secondTask.Done());
+    second.Feed(",3\n");
+    second.Finish();
+    EXPECT_TRUE(secondTask.Done());
+    EXPECT_EQ(secondNames, std::vector<std::string>({"x", "y", "z"}));
+}
+
+// rows already ready are taken without suspending, and a consumer dropped
+// while it waits no longer gets resumed
+TEST(ReaderRangeTest, AsyncNextRow) {
+    CDSVPushParser parser(',');
+    parser.Feed("a\nb\n");
+    std::size_t Count = 0;
+    {
+        STask task = CountRows(parser, Count);
+        EXPECT_EQ(Count, 2);
+        EXPECT_FALSE(task.Done());
+    }
+    parser.Feed("c\n");
+    EXPECT_EQ(Count, 2);
+    EXPECT_EQ(parser.RowsReady(), 1);
+
+    STask task = CountRows(parser, Count);
+    EXPECT_EQ(Count, 3);
+    parser.Finish();
+    EXPECT_TRUE(task.Done());
+}
+
+#endif
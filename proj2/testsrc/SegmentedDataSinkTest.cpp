@@ -0,0 +1,93 @@
+#include "gtest/gtest.h"
+#include "SegmentedDataSink.h"
+#include "SharedBufferDataSource.h"
+#include "DSVReader.h"
+#include "DSVWriter.h"
+#include <thread>
+
+// output is split into segments that are never moved
+TEST(SegmentedDataSink, WriteAcrossSegments){
+    CSegmentedDataSink Sink(4);
+    EXPECT_TRUE(Sink.Put('a'));
+    EXPECT_TRUE(Sink.Write(std::vector<char>{'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j'}));
+    EXPECT_EQ(Sink.Size(), 10);
+    EXPECT_EQ(Sink.String(), "abcdefghij");
+
+    auto Segments = Sink.Segments();
+    ASSERT_EQ(Segments.size(), 3);
+    const char *First = Segments[0]->data();
+    EXPECT_EQ(std::string(Segments[2]->begin(), Segments[2]->end()), "ij");
+
+    // handed out segments are left alone, writing continues in a new one
+    EXPECT_TRUE(Sink.Put('k'));
+    EXPECT_EQ(Segments[2]->size(), 2);
+    EXPECT_EQ(Sink.Segments().size(), 4);
+    EXPECT_EQ(Sink.Segments()[0]->data(), First);
+    EXPECT_EQ(Sink.String(), "abcdefghijk");
+}
+
+// the source reads across segments without copying them first
+TEST(SharedBufferDataSource, ReadSegments){
+    CSegmentedDataSink Sink(3);
+    std::string Data = "0123456789";
+    Sink.Write(std::vector<char>(Data.begin(), Data.end()));
+    auto Source = Sink.Source();
+
+    char Ch;
+    EXPECT_TRUE(Source->Peek(Ch));
+    EXPECT_EQ(Ch, '0');
+    EXPECT_TRUE(Source->Get(Ch));
+    std::vector<char> Buffer;
+    EXPECT_TRUE(Source->Read(Buffer, 5));
+    EXPECT_EQ(std::string(Buffer.begin(), Buffer.end()), "12345");
+    EXPECT_TRUE(Source->Seek(8));
+    EXPECT_TRUE(Source->Read(Buffer, 5));
+    EXPECT_EQ(std::string(Buffer.begin(), Buffer.end()), "89");
+    EXPECT_TRUE(Source->End());
+    EXPECT_FALSE(Source->Read(Buffer, 5));
+    EXPECT_FALSE(Source->Seek(11));
+    EXPECT_TRUE(Source->Seek(10));
+    EXPECT_TRUE(Source->End());
+
+    // borrowed and reference counted buffers
+    CSharedBufferDataSource Borrowed(std::string_view(Data).substr(2, 3));
+    EXPECT_TRUE(Borrowed.Read(Buffer, 10));
+    EXPECT_EQ(std::string(Buffer.begin(), Buffer.end()), "234");
+
+    auto Shared = std::make_shared<const std::string>("shared");
+    CSharedBufferDataSource Counted(Shared);
+    Shared.reset();
+    EXPECT_TRUE(Counted.Read(Buffer, 10));
+    EXPECT_EQ(std::string(Buffer.begin(), Buffer.end()), "shared");
+}
+
+// several readers scan one document at the same time
+TEST(SharedBufferDataSource, ConcurrentReaders){
+    auto Sink = std::make_shared<CSegmentedDataSink>(1000);
+    {
+        CDSVWriter Writer(Sink, ',');
+        for(int Index = 0; Index < 5000; Index++){
+            Writer.WriteRow({std::to_string(Index), "value", "x,y"});
+        }
+    }
+    auto Segments = Sink->Segments();
+    std::vector<std::size_t> Counts(4, 0);
+    std::vector<std::thread> Threads;
+    for(std::size_t Thread = 0; Thread < Counts.size(); Thread++){
+        Threads.emplace_back([&Segments, &Counts, Thread]{
+            CDSVReader Reader(std::make_shared<CSharedBufferDataSource>(Segments), ',');
+            std::vector<std::string> Row;
+            while(Reader.ReadRow(Row)){
+                if(Row.size() == 3 && Row[0] == std::to_string(Counts[Thread]) && Row[2] == "x,y"){
+                    Counts[Thread]++;
+                }
+            }
+        });
+    }
+    for(auto &Thread : Threads){
+        Thread.join();
+    }
+    for(auto Count : Counts){
+        EXPECT_EQ(Count, 5000);
+    }
+}
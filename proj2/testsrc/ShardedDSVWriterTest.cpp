@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include "ShardedDSVWriter.h"
+#include "DSVReader.h"
+#include "StringDataSink.h"
+#include "StringDataSource.h"
+
+namespace{
+
+// Sink whose writes always fail
+class CFailingSink : public CDataSink{
+    public:
+        bool Put(const char &) noexcept override{
+            return false;
+        }
+        
+        bool Write(const std::vector<char> &) noexcept override{
+            return false;
+        }
+};
+
+// Sink counting the writes it receives
+class CCountingSink : public CStringDataSink{
+    public:
+        std::size_t DWrites = 0;
+        
+        bool Write(const std::vector<char> &buf) noexcept override{
+            DWrites++;
+            return CStringDataSink::Write(buf);
+        }
+};
+
+}
+
+TEST(ShardedDSVWriter, RoutesByKey){
+    std::vector< std::shared_ptr<CStringDataSink> > Sinks;
+    std::vector< std::shared_ptr<CDataSink> > DataSinks;
+    for(int Index = 0; Index < 4; Index++){
+        Sinks.push_back(std::make_shared<CStringDataSink>());
+        DataSinks.push_back(Sinks.back());
+    }
+    CShardedDSVWriter Writer(DataSinks, {0, 2}, ',');
+    std::vector< std::vector< std::vector<std::string> > > Expected(4);
+
+    ASSERT_EQ(Writer.ShardCount(), 4);
+    for(int Index = 0; Index < 5000; Index++){
+        std::vector<std::string> Row = {"key" + std::to_string(Index % 37), std::to_string(Index), "x,y" + std::to_string(Index % 3)};
+        std::size_t Shard = Writer.ShardOf(Row);
+        ASSERT_LT(Shard, 4);
+        Expected[Shard].push_back(Row);
+        EXPECT_TRUE(Writer.WriteRow(Row));
+    }
+    EXPECT_TRUE(Writer.Flush());
+
+    std::size_t Total = 0;
+    for(std::size_t Shard = 0; Shard < 4; Shard++){
+        EXPECT_EQ(Writer.RowCount(Shard), Expected[Shard].size());
+        Total += Writer.RowCount(Shard);
+        CDSVReader Reader(std::make_shared<CStringDataSource>(Sinks[Shard]->String()), ',');
+        std::vector<std::string> Row;
+        for(auto &ExpectedRow : Expected[Shard]){
+            ASSERT_TRUE(Reader.ReadRow(Row));
+            EXPECT_EQ(Row, ExpectedRow);
+        }
+        EXPECT_TRUE(Reader.End());
+    }
+    EXPECT_EQ(Total, 5000);
+}
+
+TEST(ShardedDSVWriter, SameKeySameShard){
+    std::vector< std::shared_ptr<CDataSink> > Sinks = {std::make_shared<CStringDataSink>(), std::make_shared<CStringDataSink>(), std::make_shared<CStringDataSink>()};
+    CShardedDSVWriter Writer(Sinks, {1}, ',');
+
+    EXPECT_EQ(Writer.ShardOf({"a", "k"}), Writer.ShardOf({"b", "k"}));
+    EXPECT_EQ(Writer.ShardOf({"a"}), Writer.ShardOf({"b"}));
+}
+
+TEST(ShardedDSVWriter, FlushReportsErrors){
+    std::vector< std::shared_ptr<CDataSink> > Sinks = {std::make_shared<CFailingSink>()};
+    CShardedDSVWriter Writer(Sinks, {0}, ',');
+
+    EXPECT_TRUE(Writer.WriteRow({"a", "b"}));
+    EXPECT_FALSE(Writer.Flush());
+    EXPECT_TRUE(Writer.Flush());
+}
+
+TEST(ShardedDSVWriter, WriteRowReportsErrors){
+    std::vector< std::shared_ptr<CDataSink> > Sinks = {std::make_shared<CFailingSink>()};
+    CShardedDSVWriter Writer(Sinks, {0}, ',');
+    std::string Value(100, 'v');
+
+    // the worker fails once its buffer is spilled, later rows see that
+    bool Failed = false;
+    for(int Index = 0; Index < 100000 && !Failed; Index++){
+        Failed = !Writer.WriteRow({Value, std::to_string(Index)});
+    }
+    EXPECT_TRUE(Failed);
+    EXPECT_FALSE(Writer.Flush());
+    EXPECT_TRUE(Writer.WriteRow({"a"}));
+}
+
+TEST(ShardedDSVWriter, BuffersSinkWrites){
+    auto Sink = std::make_shared<CCountingSink>();
+    CShardedDSVWriter Writer({Sink}, {0}, ',');
+
+    for(int Index = 0; Index < 1000; Index++){
+        EXPECT_TRUE(Writer.WriteRow({"key", std::to_string(Index)}));
+    }
+    EXPECT_TRUE(Writer.Flush());
+    EXPECT_EQ(Writer.RowCount(0), 1000);
+    EXPECT_EQ(Sink->DWrites, 1);
+    CDSVReader Reader(std::make_shared<CStringDataSource>(Sink->String()), ',');
+    std::vector<std::string> Row;
+    for(int Index = 0; Index < 1000; Index++){
+        ASSERT_TRUE(Reader.ReadRow(Row));
+        EXPECT_EQ(Row[1], std::to_string(Index));
+    }
+}
+
+TEST(ShardedDSVWriter, NoShards){
+    CShardedDSVWriter Writer({}, {0}, ',');
+
+    EXPECT_EQ(Writer.ShardCount(), 0);
+    EXPECT_FALSE(Writer.WriteRow({"a"}));
+    EXPECT_TRUE(Writer.Flush());
+}
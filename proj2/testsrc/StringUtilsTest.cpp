@@ -3,24 +3,46 @@
 
 TEST(StringUtilsTest, SliceTest){
     EXPECT_EQ(StringUtils::Slice("Hello, World!", 0, 5), "Hello");
-    EXPECT_EQ(StringUtils::Slice("Hello, World!", 7), "Hello");
-    EXPECT_EQ(StringUtils::Slice("Hello, World!", -3), "rld!");
+    EXPECT_EQ(StringUtils::Slice("Hello, World!", 7), "World!");
+    EXPECT_EQ(StringUtils::Slice("Hello, World!", -3), "ld!");
 }
 
 TEST(StringUtilsTest, Capitalize){
     EXPECT_EQ(StringUtils::Capitalize("hello"), "Hello");
     EXPECT_EQ(StringUtils::Capitalize("WORLD"), "World");
     EXPECT_EQ(StringUtils::Capitalize("3"), "3");
+    EXPECT_EQ(StringUtils::Capitalize(""), "");
+    EXPECT_EQ(StringUtils::Capitalize("hELLO, wORLD! this IS a LONGER string"), "Hello, world! this is a longer string");
 }
 
 TEST(StringUtilsTest, Upper){
     EXPECT_EQ(StringUtils::Upper("hello"), "HELLO");
     EXPECT_EQ(StringUtils::Upper("HELLO"), "HELLO");
+    EXPECT_EQ(StringUtils::Upper(""), "");
+    EXPECT_EQ(StringUtils::Upper("the quick brown fox @[`{ jumps over 123"), "THE QUICK BROWN FOX @[`{ JUMPS OVER 123");
+    EXPECT_EQ(StringUtils::Upper("caf\xC3\xA9 caf\xC3\xA9 caf\xC3\xA9 caf\xC3\xA9"), "CAF\xC3\xA9 CAF\xC3\xA9 CAF\xC3\xA9 CAF\xC3\xA9");
 }
 
 TEST(StringUtilsTest, Lower){
     EXPECT_EQ(StringUtils::Lower("hello"), "hello");
     EXPECT_EQ(StringUtils::Lower("HELLO"), "hello");
+    EXPECT_EQ(StringUtils::Lower("THE QUICK BROWN FOX @[`{ JUMPS OVER 123"), "the quick brown fox @[`{ jumps over 123");
+}
+
+TEST(StringUtilsTest, InPlace){
+    std::string Value = "MiXeD CaSe KeY NaMe WiTh SoMe LeNgTh";
+    StringUtils::LowerInPlace(Value);
+    EXPECT_EQ(Value, "mixed case key name with some length");
+    StringUtils::UpperInPlace(Value);
+    EXPECT_EQ(Value, "MIXED CASE KEY NAME WITH SOME LENGTH");
+    StringUtils::CapitalizeInPlace(Value);
+    EXPECT_EQ(Value, "Mixed case key name with some length");
+
+    char Buffer[] = "abcDEF";
+    StringUtils::UpperInPlace(Buffer, 3);
+    EXPECT_EQ(std::string(Buffer), "ABCDEF");
+    StringUtils::CapitalizeInPlace(Buffer, 0);
+    EXPECT_EQ(std::string(Buffer), "ABCDEF");
 }
 
 TEST(StringUtilsTest, LStrip){
@@ -39,7 +61,7 @@ TEST(StringUtilsTest, Strip){
 }
 
 TEST(StringUtilsTest, Center){
-    EXPECT_EQ(StringUtils::Center("hello", 8), " hello ");
+    EXPECT_EQ(StringUtils::Center("hello", 8), " hello  ");
     EXPECT_EQ(StringUtils::Center("hello", 3), "hello");
 }
 
@@ -69,4 +91,129 @@ TEST(StringUtilsTest, ExpandTabs){
 
 TEST(StringUtilsTest, EditDistance){
     EXPECT_EQ(StringUtils::EditDistance("hello", "hello", false), 0);
-}
\ No newline at end of file
+    EXPECT_EQ(StringUtils::EditDistance("Hello", "hELLO", true), 0);
+}
+TEST(StringUtilsTest, MultiReplace){
+    StringUtils::CMultiReplacer Replacer({{"&", "&amp;"}, {"<", "&lt;"}, {">", "&gt;"}, {"", "ignored"}});
+    EXPECT_EQ(Replacer.Replace("a < b && c > d"), "a &lt; b &amp;&amp; c &gt; d");
+    EXPECT_EQ(Replacer.Replace(""), "");
+    EXPECT_EQ(Replacer.Replace("plain"), "plain");
+
+    // leftmost match first, then the longest, and replacements are not rescanned
+    EXPECT_EQ(StringUtils::Replace("abcd", {{"bc", "1"}, {"abcde", "2"}, {"cd", "3"}}), "a1d");
+    EXPECT_EQ(StringUtils::Replace("abcdf", {{"b", "1"}, {"abcde", "2"}, {"cd", "3"}}), "a13f");
+    EXPECT_EQ(StringUtils::Replace("she sells", {{"he", "HE"}, {"she", "SHE"}, {"s", "z"}}), "SHE zellz");
+    EXPECT_EQ(StringUtils::Replace("aaaa", {{"a", "aa"}}), "aaaaaaaa");
+    EXPECT_EQ(StringUtils::Replace("hello world", {{"hello", "hi"}}), StringUtils::Replace("hello world", "hello", "hi"));
+}
+
+TEST(StringUtilsTest, MultiReplaceStream){
+    // matches spanning the chunks the source is read in
+    std::string Input;
+    std::string Expected;
+    for(int Index = 0; Index < 20000; Index++){
+        Input += "<tag>" + std::to_string(Index) + " & ";
+        Expected += "[tag]" + std::to_string(Index) + " and ";
+    }
+    StringUtils::CMultiReplacer Replacer({{"<tag>", "[tag]"}, {"&", "and"}, {"<", "!"}});
+    EXPECT_EQ(Replacer.Replace(Input), Expected);
+
+    class CChunkSource : public CDataSource{
+        public:
+            std::string DData;
+            std::size_t DIndex = 0;
+            bool End() const noexcept override{ return DIndex >= DData.size(); }
+            bool Get(char &ch) noexcept override{ return !End() && (ch = DData[DIndex++], true); }
+            bool Peek(char &ch) noexcept override{ return !End() && (ch = DData[DIndex], true); }
+            bool Read(std::vector<char> &buf, std::size_t count) noexcept override{
+                std::size_t Length = std::min({count, DData.size() - DIndex, std::size_t(7)});
+                buf.assign(DData.begin() + DIndex, DData.begin() + DIndex + Length);
+                DIndex += Length;
+                return Length != 0;
+            }
+    };
+    class CCollectSink : public CDataSink{
+        public:
+            std::string DData;
+            bool Put(const char &ch) noexcept override{ DData += ch; return true; }
+            bool Write(const std::vector<char> &buf) noexcept override{ DData.append(buf.begin(), buf.end()); return true; }
+    };
+    CChunkSource Source;
+    Source.DData = Input + "<ta";
+    CCollectSink Sink;
+    EXPECT_TRUE(Replacer.Replace(Source, Sink));
+    EXPECT_EQ(Sink.DData, Expected + "!ta");
+}
+
+TEST(StringUtilsTest, MultiReplaceShortReads){
+    // reads of one to three bytes split every pattern and every pending
+    // longer candidate, the output matches the in-memory replacement
+    class CShortSource : public CDataSource{
+        public:
+            std::string DData;
+            std::size_t DIndex = 0;
+            std::size_t DReads = 0;
+            bool End() const noexcept override{ return DIndex >= DData.size(); }
+            bool Get(char &ch) noexcept override{ return !End() && (ch = DData[DIndex++], true); }
+            bool Peek(char &ch) noexcept override{ return !End() && (ch = DData[DIndex], true); }
+            bool Read(std::vector<char> &buf, std::size_t count) noexcept override{
+                std::size_t Length = std::min({count, DData.size() - DIndex, 1 + DReads++ % 3});
+                buf.assign(DData.begin() + DIndex, DData.begin() + DIndex + Length);
+                DIndex += Length;
+                return Length != 0;
+            }
+    };
+    class CCollectSink : public CDataSink{
+        public:
+            std::string DData;
+            bool Put(const char &ch) noexcept override{ DData += ch; return true; }
+            bool Write(const std::vector<char> &buf) noexcept override{ DData.append(buf.begin(), buf.end()); return true; }
+    };
+    StringUtils::CMultiReplacer Replacer({{"bc", "1"}, {"abcde", "2"}, {"cd", "3"}, {"he", "HE"}, {"she", "SHE"}, {"s", "z"}});
+    std::string Input = "abcd abcdf abcde she sells abcdabcde shshe abc";
+    for(std::size_t Start = 0; Start < 3; Start++){
+        CShortSource Source;
+        Source.DData = Input;
+        Source.DReads = Start;
+        CCollectSink Sink;
+        EXPECT_TRUE(Replacer.Replace(Source, Sink));
+        EXPECT_EQ(Sink.DData, Replacer.Replace(Input));
+    }
+    EXPECT_EQ(Replacer.Replace(Input), "a1d a1df 2 SHE zellz a1d2 zhSHE a1");
+}
+
+TEST(StringUtilsTest, MultiReplaceOverlapping){
+    // every "a" is a match a much longer pattern is still being tried for,
+    // rescanning after each match would take input times pattern length
+    std::string Long = std::string(5000, 'a') + "b";
+    StringUtils::CMultiReplacer Replacer({{"a", "1"}, {Long, "2"}});
+    std::string Input = std::string(200000, 'a') + Long + "ab" + std::string(70000, 'c') + "a";
+    std::string Expected = std::string(200000, '1') + "2" + "1b" + std::string(70000, 'c') + "1";
+    EXPECT_EQ(Replacer.Replace(Input), Expected);
+
+    class CChunkSource : public CDataSource{
+        public:
+            std::string DData;
+            std::size_t DIndex = 0;
+            bool End() const noexcept override{ return DIndex >= DData.size(); }
+            bool Get(char &ch) noexcept override{ return !End() && (ch = DData[DIndex++], true); }
+            bool Peek(char &ch) noexcept override{ return !End() && (ch = DData[DIndex], true); }
+            bool Read(std::vector<char> &buf, std::size_t count) noexcept override{
+                std::size_t Length = std::min({count, DData.size() - DIndex, std::size_t(4099)});
+                buf.assign(DData.begin() + DIndex, DData.begin() + DIndex + Length);
+                DIndex += Length;
+                return Length != 0;
+            }
+    };
+    class CCollectSink : public CDataSink{
+        public:
+            std::string DData;
+            bool Put(const char &ch) noexcept override{ DData += ch; return true; }
+            bool Write(const std::vector<char> &buf) noexcept override{ DData.append(buf.begin(), buf.end()); return true; }
+    };
+    CChunkSource Source;
+    Source.DData = Input;
+    CCollectSink Sink;
+    EXPECT_TRUE(Replacer.Replace(Source, Sink));
+    EXPECT_EQ(Sink.DData, Expected);
+}
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include "WriteBehindDataSink.h"
+#include "StringDataSink.h"
+#include "DSVWriter.h"
+#include "XMLWriter.h"
+#include <chrono>
+#include <thread>
+
+namespace{
+
+// Sink that is slow and can be made to fail
+class CTestSink : public CDataSink{
+    public:
+        std::string DString;
+        std::size_t DWrites = 0;
+        std::size_t DFailAfter = SIZE_MAX;
+        std::size_t DFlushes = 0;
+        
+        bool Put(const char &ch) noexcept override{
+            return Write(std::vector<char>{ch});
+        }
+        
+        bool Write(const std::vector<char> &buf) noexcept override{
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            if(DWrites++ >= DFailAfter){
+                return false;
+            }
+            DString.append(buf.data(), buf.size());
+            return true;
+        }
+        
+        bool Flush() noexcept override{
+            DFlushes++;
+            return true;
+        }
+};
+
+}
+
+TEST(WriteBehindDataSink, PutWriteTest){
+    auto Sink = std::make_shared<CStringDataSink>();
+    CWriteBehindDataSink WriteBehind(Sink, 4, 2);
+
+    EXPECT_TRUE(WriteBehind.Put('H'));
+    EXPECT_TRUE(WriteBehind.Write(std::vector<char>{'e','l','l','o'}));
+    EXPECT_TRUE(WriteBehind.Write(std::vector<char>{' ','W','o','r','l','d'}));
+    EXPECT_TRUE(WriteBehind.Flush());
+    EXPECT_EQ(Sink->String(), "Hello World");
+    EXPECT_TRUE(WriteBehind.Put('!'));
+    EXPECT_TRUE(WriteBehind.Flush());
+    EXPECT_EQ(Sink->String(), "Hello World!");
+}
+
+TEST(WriteBehindDataSink, Backpressure){
+    auto Sink = std::make_shared<CTestSink>();
+    std::string Expected;
+    {
+        CWriteBehindDataSink WriteBehind(Sink, 16, 2);
+        for(int Index = 0; Index < 200; Index++){
+            std::string Line = "line " + std::to_string(Index) + "\n";
+            Expected += Line;
+            EXPECT_TRUE(WriteBehind.Write(std::vector<char>(Line.begin(), Line.end())));
+        }
+    }
+    EXPECT_EQ(Sink->DString, Expected);
+    EXPECT_EQ(Sink->DFlushes, 1);
+}
+
+TEST(WriteBehindDataSink, ErrorReportedOnFlush){
+    auto Sink = std::make_shared<CTestSink>();
+    Sink->DFailAfter = 1;
+    CWriteBehindDataSink WriteBehind(Sink, 4, 4);
+
+    EXPECT_TRUE(WriteBehind.Write(std::vector<char>{'a','b','c','d'}));
+    EXPECT_TRUE(WriteBehind.Write(std::vector<char>{'e','f','g','h'}));
+    EXPECT_FALSE(WriteBehind.Flush());
+    EXPECT_FALSE(WriteBehind.Put('x'));
+    EXPECT_EQ(Sink->DString, "abcd");
+}
+
+TEST(WriteBehindDataSink, DSVWriterTest){
+    auto Sink = std::make_shared<CStringDataSink>();
+    auto WriteBehind = std::make_shared<CWriteBehindDataSink>(Sink, 64);
+    CDSVWriter Writer(WriteBehind, ',');
+    std::string Expected;
+
+    for(int Index = 0; Index < 1000; Index++){
+        EXPECT_TRUE(Writer.WriteRow({std::to_string(Index), "a,b"}));
+        Expected += std::to_string(Index) + ",\"a,b\"\n";
+    }
+    EXPECT_TRUE(WriteBehind->Flush());
+    EXPECT_EQ(Sink->String(), Expected);
+}
+
+TEST(WriteBehindDataSink, XMLWriterFlushReportsError){
+    auto Sink = std::make_shared<CTestSink>();
+    Sink->DFailAfter = 0;
+    CXMLWriter Writer(std::make_shared<CWriteBehindDataSink>(Sink));
+    SXMLEntity Entity;
+    Entity.DType = SXMLEntity::EType::StartElement;
+    Entity.DNameData = "root";
+
+    EXPECT_TRUE(Writer.WriteEntity(Entity));
+    EXPECT_FALSE(Writer.Flush());
+}
@@ -0,0 +1,42 @@
+#include <gtest/gtest.h>
+#include "XMLFlattener.h"
+#include "StringDataSource.h"
+#include "StringDataSink.h"
+
+TEST(XMLFlattener, FlattenRecords){
+    std::string Data = "<rows>"
+                       "<row a=\"1\" b=\"x,y\"><c>first</c><d k=\"v1\"/><ignored>z</ignored></row>"
+                       "<other a=\"9\"/>"
+                       "<row a=\"2\"><c>sec<i>o</i>nd</c></row>"
+                       "<row b=\"&quot;q&quot;\"/>"
+                       "</rows>";
+    CXMLFlattener Flattener("row", {SXMLFlattenColumn::Attribute("a"), SXMLFlattenColumn::ChildText("c"), SXMLFlattenColumn::Attribute("b"), SXMLFlattenColumn::ChildAttribute("d", "k")});
+    auto Sink = std::make_shared<CStringDataSink>();
+    CDSVWriter Writer(Sink, ',');
+
+    EXPECT_TRUE(Flattener.Flatten(std::make_shared<CStringDataSource>(Data), Writer, true));
+    EXPECT_EQ(Flattener.RecordCount(), 3);
+    EXPECT_EQ(Sink->String(), "a,c,b,d@k\n"
+                              "1,first,\"x,y\",v1\n"
+                              "2,second,,\n"
+                              ",,\"\"\"q\"\"\",\n");
+}
+
+TEST(XMLFlattener, NestedRecordIsChild){
+    std::string Data = "<row id=\"outer\"><row id=\"inner\"><name>n</name></row><name>o</name></row>";
+    CXMLFlattener Flattener("row", {SXMLFlattenColumn::Attribute("id"), SXMLFlattenColumn::ChildText("name")});
+    auto Sink = std::make_shared<CStringDataSink>();
+    CDSVWriter Writer(Sink, '\t');
+
+    EXPECT_TRUE(Flattener.Flatten(std::make_shared<CStringDataSource>(Data), Writer));
+    EXPECT_EQ(Flattener.RecordCount(), 1);
+    EXPECT_EQ(Sink->String(), "outer\to\n");
+}
+
+TEST(XMLFlattener, MalformedXML){
+    CXMLFlattener Flattener("row", {SXMLFlattenColumn::Attribute("a")});
+    auto Sink = std::make_shared<CStringDataSink>();
+    CDSVWriter Writer(Sink, ',');
+
+    EXPECT_FALSE(Flattener.Flatten(std::make_shared<CStringDataSource>("<rows><row a=\"1\"></rows>"), Writer));
+}
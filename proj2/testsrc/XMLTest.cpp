@@ -3,6 +3,8 @@
 #include "XMLWriter.h"
 #include "StringDataSource.h"
 #include "StringDataSink.h"
+#include "ReadAheadDataSource.h"
+#include <cstring>
 
 TEST(XMLReaderTest, SimpleXML) {
     //reading simple XML file
@@ -26,4 +28,193 @@ TEST(XMLWriterTest, NestedElements) {
 
 TEST(XMLWriterTest, Attributes) {
     //  write XML with attributes
-}
\ No newline at end of file
+}
+
+TEST(XMLReaderTest, ReadAheadSource) {
+    // reading a document larger than one parse chunk through a read ahead source
+    std::string data = "<list>";
+    for (int i = 0; i < 5000; ++i) {
+        data += "<item id=\"" + std::to_string(i) + "\">text</item>";
+    }
+    data += "</list>";
+    auto source = std::make_shared<CReadAheadDataSource>(std::make_shared<CStringDataSource>(data), 1000, 3);
+    CXMLReader reader(source);
+    SXMLEntity entity;
+
+    ASSERT_TRUE(reader.ReadEntity(entity));
+    EXPECT_EQ(entity.DType, SXMLEntity::EType::StartElement);
+    EXPECT_EQ(entity.DNameData, "list");
+    int items = 0;
+    while (reader.ReadEntity(entity, true)) {
+        if (entity.DType == SXMLEntity::EType::StartElement) {
+            EXPECT_EQ(entity.DNameData, "item");
+            EXPECT_EQ(entity.AttributeValue("id"), std::to_string(items));
+            items++;
+        }
+    }
+    EXPECT_EQ(items, 5000);
+    EXPECT_TRUE(reader.End());
+}
+
+namespace {
+
+// records the events it receives as text
+class CRecordingHandler : public CXMLHandler {
+    public:
+        std::vector<std::string> events;
+
+        void StartElement(const SXMLName &name, const std::vector<SXMLAttributeView> &attributes) override {
+            std::string event = "start " + std::string(name.DNamespace) + " " + std::string(name.DLocal);
+            for (auto &attribute : attributes) {
+                event += " " + std::string(attribute.DName.DNamespace) + ":" + std::string(attribute.DName.DLocal) + "=" + std::string(attribute.DValue);
+            }
+            events.push_back(event);
+        }
+
+        void EndElement(const SXMLName &name) override {
+            events.push_back("end " + std::string(name.DLocal));
+        }
+
+        void CharData(std::string_view data) override {
+            if (!events.empty() && events.back().compare(0, 5, "text ") == 0) {
+                events.back() += data;
+            }
+            else {
+                events.push_back("text " + std::string(data));
+            }
+        }
+};
+
+}
+
+TEST(XMLReaderTest, CallbackHandler) {
+    // events go straight to the handler
+    std::string data = "<a x=\"1\"><b>hi &amp; bye</b><c/></a>";
+    CXMLReader reader(std::make_shared<CStringDataSource>(data));
+    CRecordingHandler handler;
+
+    EXPECT_TRUE(reader.Parse(handler));
+    EXPECT_EQ(handler.events, (std::vector<std::string>{"start  a :x=1", "start  b", "text hi & bye", "end b", "start  c", "end c", "end a"}));
+    EXPECT_TRUE(reader.End());
+
+    CXMLReader skipping(std::make_shared<CStringDataSource>(data));
+    CRecordingHandler skipped;
+    EXPECT_TRUE(skipping.Parse(skipped, true));
+    EXPECT_EQ(skipped.events.size(), 6);
+
+    CXMLReader broken(std::make_shared<CStringDataSource>("<a><b></a>"));
+    CRecordingHandler ignored;
+    EXPECT_FALSE(broken.Parse(ignored));
+}
+
+TEST(XMLReaderTest, Namespaces) {
+    // namespace aware mode reports the URI and local name
+    std::string data = "<p:root xmlns:p=\"urn:p\" xmlns=\"urn:d\" p:id=\"7\" plain=\"8\"><child/></p:root>";
+    CXMLReader reader(std::make_shared<CStringDataSource>(data), true);
+    CRecordingHandler handler;
+
+    EXPECT_TRUE(reader.Parse(handler));
+    ASSERT_EQ(handler.events.size(), 4);
+    EXPECT_EQ(handler.events[0], "start urn:p root urn:p:id=7 :plain=8");
+    EXPECT_EQ(handler.events[1], "start urn:d child");
+
+    // entities carry namespaced names as {URI}local
+    CXMLReader entityReader(std::make_shared<CStringDataSource>(data), true);
+    SXMLEntity entity;
+    ASSERT_TRUE(entityReader.ReadEntity(entity));
+    EXPECT_EQ(entity.DNameData, "{urn:p}root");
+    EXPECT_EQ(entity.AttributeValue("{urn:p}id"), "7");
+    EXPECT_EQ(entity.AttributeValue("plain"), "8");
+    ASSERT_TRUE(entityReader.ReadEntity(entity));
+    EXPECT_EQ(entity.DNameData, "{urn:d}child");
+
+    // without namespaces names are left as written
+    CXMLReader plainReader(std::make_shared<CStringDataSource>(data));
+    ASSERT_TRUE(plainReader.ReadEntity(entity));
+    EXPECT_EQ(entity.DNameData, "p:root");
+    EXPECT_EQ(entity.AttributeValue("xmlns:p"), "urn:p");
+}
+
+TEST(XMLReaderTest, PmrEntities) {
+    // entities read into a memory resource keep their strings there
+    std::string data = "<record identifier=\"a fairly long attribute value\">some character data here<next/></record>";
+    char arena[8192];
+    std::pmr::monotonic_buffer_resource resource(arena, sizeof(arena), std::pmr::null_memory_resource());
+    CXMLReader reader(std::make_shared<CStringDataSource>(data));
+
+    SPmrXMLEntity entity(&resource);
+    ASSERT_TRUE(reader.ReadEntity(entity));
+    EXPECT_EQ(entity.DType, SXMLEntity::EType::StartElement);
+    EXPECT_EQ(entity.DNameData, "record");
+    EXPECT_EQ(entity.AttributeValue("identifier"), "a fairly long attribute value");
+    EXPECT_EQ(entity.get_allocator().resource(), &resource);
+    const char *value = entity.DAttributes[0].second.data();
+    EXPECT_TRUE(value >= arena && value < arena + sizeof(arena));
+
+    ASSERT_TRUE(reader.ReadEntity(entity));
+    EXPECT_EQ(entity.DType, SXMLEntity::EType::CharData);
+    EXPECT_EQ(entity.DNameData, "some character data here");
+
+    // both overloads can be mixed on one reader
+    SXMLEntity plain;
+    ASSERT_TRUE(reader.ReadEntity(plain));
+    EXPECT_EQ(plain.DType, SXMLEntity::EType::StartElement);
+    EXPECT_EQ(plain.DNameData, "next");
+    ASSERT_TRUE(reader.ReadEntity(entity));
+    EXPECT_EQ(entity.DType, SXMLEntity::EType::EndElement);
+    EXPECT_EQ(entity.DNameData, "next");
+}
+
+TEST(XMLReaderTest, PmrResourceReleasedBetweenReads) {
+    // the caller's arena can be released once it is done with an entity
+    std::string data = "<record identifier=\"a fairly long attribute value\"><field name=\"another long attribute value\">character data long enough to allocate</field></record>";
+    char arena[8192];
+    std::pmr::monotonic_buffer_resource resource(arena, sizeof(arena), std::pmr::null_memory_resource());
+    CXMLReader reader(std::make_shared<CStringDataSource>(data));
+    std::vector<std::string> names;
+
+    bool more = true;
+    while (more) {
+        {
+            SPmrXMLEntity entity(&resource);
+            more = reader.ReadEntity(entity);
+            if (more) {
+                names.push_back(std::string(entity.DNameData) + ":" + std::string(entity.AttributeValue("name")));
+            }
+        }
+        resource.release();
+        std::memset(arena, 'X', sizeof(arena));
+    }
+    EXPECT_EQ(names, std::vector<std::string>({"record:", "field:another long attribute value", "character data long enough to allocate:", "field:", "record:"}));
+}
+
+TEST(XMLWriterTest, DirectElements) {
+    // elements written without building entities
+    auto sink = std::make_shared<CStringDataSink>();
+    CXMLWriter writer(sink);
+
+    EXPECT_TRUE(writer.StartElement("root"));
+    EXPECT_TRUE(writer.Attribute("id", "a&b"));
+    EXPECT_TRUE(writer.Attribute("quote", "\"x\""));
+    EXPECT_EQ(sink->String(), ""); // the start tag can still take attributes
+    EXPECT_TRUE(writer.Text("1 < 2"));
+    EXPECT_EQ(sink->String(), "<root id=\"a&amp;b\" quote=\"&quot;x&quot;\">1 &lt; 2");
+    EXPECT_FALSE(writer.Attribute("late", "value"));
+
+    EXPECT_TRUE(writer.StartElement("empty"));
+    EXPECT_TRUE(writer.EndElement());
+    EXPECT_TRUE(writer.StartElement("child"));
+    EXPECT_TRUE(writer.Text("text"));
+    EXPECT_TRUE(writer.EndElement());
+
+    // entities and direct calls share one element stack
+    SXMLEntity entity;
+    entity.DType = SXMLEntity::EType::StartElement;
+    entity.DNameData = "nested";
+    EXPECT_TRUE(writer.WriteEntity(entity));
+    EXPECT_TRUE(writer.EndElement());
+    EXPECT_TRUE(writer.StartElement("open"));
+    EXPECT_TRUE(writer.Flush());
+    EXPECT_EQ(sink->String(), "<root id=\"a&amp;b\" quote=\"&quot;x&quot;\">1 &lt; 2<empty/><child>text</child><nested></nested><open></open></root>");
+    EXPECT_FALSE(writer.EndElement());
+}